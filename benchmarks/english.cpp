@@ -2,12 +2,17 @@
 
 #include <string>
 #include <fstream>
+#include <iterator>
+#include <numeric>
+#include <algorithm>
+#include <cassert>
 #include <memory>
 #include <random>
 
 #include <unicode/unistr.h>
 #include <unicode/brkiter.h>
 
+#include "unicode/literals.hpp"
 #include "unicode/string_view.hpp"
 
 #include "../sources/icu.hpp"
@@ -18,8 +23,8 @@ static std::string getFileContent(const std::string& filename)
 	std::ifstream file(filename);
 	assert(file && "file not found");
 	return std::string{
-		std::istream_iterator<char>(file), 
-		std::istream_iterator<char>()
+		std::istreambuf_iterator<char>(file), 
+		std::istreambuf_iterator<char>()
 	};
 }
 
@@ -94,5 +99,186 @@ static void englishWithUnicodeStringView(benchmark::State& state)
 }
 BENCHMARK(englishWithUnicodeStringView);
 
+/// Create view over literal, splitting it at runtime
+static void literalWithUnicodeStringView(benchmark::State& state) 
+{
+	for (auto _ : state)
+	{
+		unicode::string_view str = "Привет, мир! Hello, world! 你好，世界！";
+		benchmark::DoNotOptimize(str);
+	}
+}
+BENCHMARK(literalWithUnicodeStringView);
+
+/// Create view over literal with layout, computed at compile time
+static void literalWithUSV(benchmark::State& state) 
+{
+	using namespace unicode::literals;
+	for (auto _ : state)
+	{
+		auto str = "Привет, мир! Hello, world! 你好，世界！"_usv;
+		benchmark::DoNotOptimize(str);
+	}
+}
+BENCHMARK(literalWithUSV);
+
+/// Get short strings with emoji and combining marks, that need ICU
+static const std::vector<std::string> &getTemplates()
+{
+	static const std::vector<std::string> templates = []
+	{
+		std::vector<std::string> strings;
+		for (size_t i = 0; i < 64; ++i)
+		{
+			strings.push_back(
+				"👍🏽 Сообщение " + std::to_string(i) + " в кафе\u0301 🇺🇸"
+			);
+		}
+		return strings;
+	}();
+	return templates;
+}
+
+/// Create views over strings, that need ICU, splitting each of them
+static void templatesWithUnicodeStringView(benchmark::State& state) 
+{
+	auto &templates = getTemplates();
+	for (auto _ : state)
+	{
+		for (auto &string : templates)
+		{
+			unicode::string_view str = string;
+			benchmark::DoNotOptimize(str);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * templates.size());
+}
+BENCHMARK(templatesWithUnicodeStringView);
+
+/// Create views over strings, that need ICU, with layouts from cache
+static void templatesWithLayoutCache(benchmark::State& state) 
+{
+	auto &templates = getTemplates();
+	unicode::layout_cache cache;
+	for (auto _ : state)
+	{
+		for (auto &string : templates)
+		{
+			unicode::string_view str(string, cache);
+			benchmark::DoNotOptimize(str);
+		}
+	}
+	state.SetItemsProcessed(state.iterations() * templates.size());
+}
+BENCHMARK(templatesWithLayoutCache);
+
+/// Get text in all languages, repeated to about 1MB
+static const std::string &getMixed()
+{
+	static const std::string content = []
+	{
+		std::string text;
+		for (auto language : {
+			"chinese", "english", "french", "german", 
+			"japanese", "korean", "russian"
+		})
+		{
+			text += getFileContent(
+				std::string("data/") + language + "/wiki.txt"
+			);
+		}
+		for (auto part = text; !text.empty() && text.size() < (1 << 20);)
+		{
+			text += part;
+		}
+		return text;
+	}();
+	return content;
+}
+
+/// Random access to string with characters of all sizes.
+/// Its layout has many blocks, so block lookup dominates
+static void mixedWithUnicodeStringView(benchmark::State& state) 
+{
+	unicode::string_view str = getMixed();
+	static const std::vector<size_t> indexes = shuffleIndexes(str.size());
+
+	for (auto _ : state)
+	{
+		auto c = str[indexes[state.iterations() % indexes.size()]];
+		benchmark::DoNotOptimize(c);
+	}
+	state.counters["blocks"] = static_cast<double>(str.blocks().size());
+}
+BENCHMARK(mixedWithUnicodeStringView);
+
+/// Text, that is missing from mixed text, so search scans all of it
+static constexpr std::string_view missingNeedle = "Привет, мир! 🇺🇸";
+
+/// Find missing bytes in mixed text with std::string_view
+static void mixedFindWithSTD(benchmark::State& state) 
+{
+	std::string_view str = getMixed();
+	auto needle = missingNeedle;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(str.find(needle));
+	}
+	state.SetBytesProcessed(state.iterations() * str.size());
+}
+BENCHMARK(mixedFindWithSTD);
+
+/// Find missing characters in mixed text, checking boundaries of matches
+static void mixedFindWithUnicodeStringView(benchmark::State& state) 
+{
+	unicode::string_view str = getMixed();
+	auto needle = missingNeedle;
+
+	for (auto _ : state)
+	{
+		benchmark::DoNotOptimize(str.find(needle));
+	}
+	state.SetBytesProcessed(state.iterations() * getMixed().size());
+}
+BENCHMARK(mixedFindWithUnicodeStringView);
+
+/// Get text, that changes character size every few characters, 
+/// like Korean chat with Latin words and emoji
+static const std::string &getFragmented()
+{
+	static const std::string content = []
+	{
+		const char *pieces[] = {"a", "b", " ", "한", "국", "é", "👍"};
+		std::default_random_engine engine{7};
+		std::uniform_int_distribution<size_t> piece(0, std::size(pieces) - 1);
+		std::string text;
+		while (text.size() < (1 << 20)) { text += pieces[piece(engine)]; }
+		return text;
+	}();
+	return content;
+}
+
+/// Random access to fragmented string with layout of forced strategy
+static void fragmentedWithUnicodeStringView(benchmark::State& state) 
+{
+	auto &text = getFragmented();
+	auto strategy = static_cast<unicode::layout_strategy>(state.range(0));
+	unicode::string_view str(text, unicode::layout::of(text, strategy));
+	static const std::vector<size_t> indexes = shuffleIndexes(str.size());
+
+	for (auto _ : state)
+	{
+		auto c = str[indexes[state.iterations() % indexes.size()]];
+		benchmark::DoNotOptimize(c);
+	}
+	state.counters["layout_bytes"] = 
+		static_cast<double>(str.blocks().allocated_bytes());
+}
+BENCHMARK(fragmentedWithUnicodeStringView)
+	->ArgName("strategy")
+	->Arg(static_cast<int>(unicode::layout_strategy::blocks))
+	->Arg(static_cast<int>(unicode::layout_strategy::sampled));
+
 
 BENCHMARK_MAIN();
\ No newline at end of file
@@ -4,6 +4,8 @@
 #include <fstream>
 #include <memory>
 #include <random>
+#include <vector>
+#include <cassert>
 
 #include <unicode/unistr.h>
 #include <unicode/brkiter.h>
@@ -61,8 +63,39 @@ using namespace unicode;
 	} \
 	BENCHMARK(name ## BreakIterator);
 
+#define BENCHMARK_STRING_REVERSE_ITERATOR_LANGUAGE(name) \
+	static void name ## StringReverseIterator(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		string_view unicode = content; \
+		for (auto _ : state) \
+		{ \
+			for (auto it = unicode.rbegin(); it != unicode.rend(); ++it) \
+			{ \
+				benchmark::DoNotOptimize(*it); \
+			} \
+		} \
+	} \
+	BENCHMARK(name ## StringReverseIterator);
+
+#define BENCHMARK_STRING_BOUNDARIES_LANGUAGE(name) \
+	static void name ## StringBoundaries(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		string_view unicode = content; \
+		std::vector<uint32_t> boundaries(unicode.size()); \
+		for (auto _ : state) \
+		{ \
+			unicode.copy_boundaries(boundaries); \
+			benchmark::DoNotOptimize(boundaries.data()); \
+		} \
+	} \
+	BENCHMARK(name ## StringBoundaries);
+
 #define BENCHMARK_LANGUAGE(name) \
 	BENCHMARK_STRING_ITERATOR_LANGUAGE(name) \
+	BENCHMARK_STRING_BOUNDARIES_LANGUAGE(name) \
+	BENCHMARK_STRING_REVERSE_ITERATOR_LANGUAGE(name) \
 	BENCHMARK_BREAK_ITERATOR_LANGUAGE(name)
 
 
@@ -0,0 +1,205 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "unicode/line_reader.hpp"
+#include "unicode/string_view.hpp"
+
+using namespace unicode;
+
+/// Get synthetic mixed-script text of specified size in bytes
+static const std::string &getText(size_t size)
+{
+	static const std::string sample =
+		"The quick brown fox jumps over the lazy dog. "
+		"Съешь же ещё этих мягких французских булок. "
+		"敏捷的棕色狐狸跳过了懒狗。"
+		"빠른 갈색 여우가 게으른 개를 뛰어넘는다. "
+		"Café, naïve, jalapeño 👍🏽 🇺🇸 👨‍👩‍👧\n";
+
+	static std::map<size_t, std::string> texts;
+	auto &text = texts[size];
+	if (text.empty())
+	{
+		text.reserve(size);
+		while (text.size() + sample.size() <= size) { text += sample; }
+		text.append(size - text.size(), 'a');
+	}
+	return text;
+}
+
+/// Layout of synthetic text from 1 KB to 1 GB
+static void scalingLayout(benchmark::State& state)
+{
+	auto &text = getText(state.range(0));
+	for (auto _ : state)
+	{
+		auto layout = layout::of(text);
+		benchmark::DoNotOptimize(layout);
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(scalingLayout)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 30)
+	->Unit(benchmark::kMicrosecond)
+	->Complexity(benchmark::oN);
+
+/// Parallel layout of synthetic text from 1 MB to 1 GB, 
+/// split into chunk per hardware thread
+static void scalingParallelLayout(benchmark::State& state)
+{
+	auto &text = getText(state.range(0));
+	auto threads_count = std::max(1u, std::thread::hardware_concurrency());
+	for (auto _ : state)
+	{
+		std::vector<std::jthread> threads;
+		auto layout = layout::of(
+			text,
+			[&](auto task) { threads.emplace_back(std::move(task)); },
+			text.size() / threads_count + 1
+		);
+		benchmark::DoNotOptimize(layout);
+	}
+	state.SetBytesProcessed(state.iterations() * text.size());
+	state.counters["threads"] = threads_count;
+}
+BENCHMARK(scalingParallelLayout)
+	->RangeMultiplier(8)->Range(1 << 20, 1 << 30)
+	->Unit(benchmark::kMicrosecond)
+	->UseRealTime();
+
+/// Random access to synthetic text from 1 KB to 1 GB
+static void scalingRandomAccess(benchmark::State& state)
+{
+	string_view view = getText(state.range(0));
+	auto size = view.size();
+	size_t index = 0;
+	for (auto _ : state)
+	{
+		// Linear congruential generator is cheaper than std::rand
+		index = (index * 6364136223846793005ULL + 1442695040888963407ULL);
+		auto c = view[(index >> 17) % size];
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(scalingRandomAccess)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 30)
+	->Complexity(benchmark::oLogN);
+
+/// Conversion of random byte offsets in synthetic text from 1 KB to 1 GB
+/// to indices of characters, that contain them
+static void scalingIndexOfByte(benchmark::State& state)
+{
+	auto &text = getText(state.range(0));
+	string_view view = text;
+	auto size = text.size();
+	size_t offset = 0;
+	for (auto _ : state)
+	{
+		offset = (offset * 6364136223846793005ULL + 1442695040888963407ULL);
+		auto index = view.index_of_byte((offset >> 17) % size);
+		benchmark::DoNotOptimize(index);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(scalingIndexOfByte)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 30)
+	->Complexity(benchmark::oLogN);
+
+/// Memory used by view of synthetic text from 1 KB to 1 GB
+static void scalingMemory(benchmark::State& state)
+{
+	auto &text = getText(state.range(0));
+	size_t bytes = 0;
+	for (auto _ : state)
+	{
+		bytes = sizeof(string_view) + layout::of(text).allocated_bytes();
+	}
+	state.counters["bytes_per_view"] = double(bytes);
+	state.counters["overhead"] = double(bytes) / text.size();
+}
+BENCHMARK(scalingMemory)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 30)
+	->Unit(benchmark::kMillisecond);
+
+/// Access to the first characters of lazy view over synthetic text
+static void scalingLazyFront(benchmark::State& state)
+{
+	auto &text = getText(state.range(0));
+	for (auto _ : state)
+	{
+		string_view view(text, lazy);
+		auto c = view[10];
+		benchmark::DoNotOptimize(c);
+	}
+	state.SetComplexityN(state.range(0));
+}
+BENCHMARK(scalingLazyFront)
+	->RangeMultiplier(8)->Range(1 << 10, 1 << 30)
+	->Complexity(benchmark::o1);
+
+/// Get path of file with synthetic text of specified size in bytes
+static std::filesystem::path getTextFile(size_t size)
+{
+	auto path = std::filesystem::temp_directory_path() / (
+		"unicode_scaling_" + std::to_string(size) + ".txt"
+	);
+	if (
+		!std::filesystem::exists(path) || 
+		std::filesystem::file_size(path) != size
+	)
+	{
+		auto &text = getText(size);
+		std::ofstream file(path, std::ios::binary | std::ios::trunc);
+		file.write(text.data(), text.size());
+	}
+	return path;
+}
+
+/// Reading synthetic file from 1 MB to 256 MB by lines, split into 
+/// characters while the rest of file is read, or after reading the whole file
+static void scalingReadLines(benchmark::State& state)
+{
+	auto path = getTextFile(state.range(0));
+	for (auto _ : state)
+	{
+		size_t characters = 0;
+		if (state.range(1) == 0)
+		{
+			line_reader reader(path);
+			for (auto &line : reader) { characters += line.size(); }
+		}
+		else
+		{
+			std::ifstream file(path, std::ios::binary);
+			std::string content(std::filesystem::file_size(path), '\0');
+			file.read(content.data(), content.size());
+			for (size_t begin = 0; begin < content.size();)
+			{
+				auto end = std::min(content.find('\n', begin), content.size());
+				auto line = std::string_view(content).substr(begin, end - begin);
+				characters += string_view(line).size();
+				begin = end + 1;
+			}
+		}
+		benchmark::DoNotOptimize(characters);
+	}
+	state.SetBytesProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(scalingReadLines)
+	->ArgNames({"size", "sequential"})
+	->ArgsProduct({
+		benchmark::CreateRange(1 << 20, 1 << 28, 16), {0, 1}
+	})
+	->Unit(benchmark::kMillisecond)
+	->UseRealTime();
+
+BENCHMARK_MAIN();
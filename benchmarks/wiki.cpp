@@ -1,14 +1,23 @@
 #include <benchmark/benchmark.h>
 
+#include <algorithm>
+#include <map>
 #include <string>
+#include <unordered_map>
 #include <fstream>
 #include <memory>
 #include <random>
+#include <ranges>
+#include <vector>
+#include <cassert>
 
 #include <unicode/unistr.h>
 #include <unicode/brkiter.h>
 
+#include "unicode/collator.hpp"
+#include "unicode/sort_key.hpp"
 #include "unicode/string_view.hpp"
+#include "unicode/utf8/grapheme.hpp"
 
 #include "../sources/icu.hpp"
 
@@ -22,8 +31,83 @@ static std::string readFile(const std::string &path)
 	return content;
 }
 
+/// Split text into lines
+static std::vector<std::string_view> splitLines(std::string_view text)
+{
+	std::vector<std::string_view> lines;
+	for (auto line : std::views::split(text, '\n'))
+	{
+		lines.emplace_back(line.begin(), line.end());
+	}
+	return lines;
+}
+
+/// Split text into words, separated by spaces
+static std::vector<std::string_view> splitWords(std::string_view text)
+{
+	std::vector<std::string_view> words;
+	for (auto line : splitLines(text))
+	{
+		for (auto word : std::views::split(line, ' '))
+		{
+			if (word.empty()) { continue; }
+			words.emplace_back(word.begin(), word.end());
+		}
+	}
+	return words;
+}
+
 using namespace unicode;
 
+/// Repeat strings up to given number of views
+static std::vector<string_view> repeat(
+	const std::vector<std::string_view> &strings,
+	size_t count
+)
+{
+	std::vector<string_view> views;
+	views.reserve(count);
+	for (size_t i = 0; i < count; ++i)
+	{
+		views.emplace_back(strings[i % strings.size()]);
+	}
+	return views;
+}
+
+/// Split text into lines and repeat them up to given number of views
+static std::vector<string_view> repeatLines(std::string_view text, size_t count)
+{
+	return repeat(splitLines(text), count);
+}
+
+/// Split text into words and repeat them up to given number of views
+static std::vector<string_view> repeatWords(std::string_view text, size_t count)
+{
+	return repeat(splitWords(text), count);
+}
+
+/// Hash every character of run. Width is size of characters,
+/// known at compile time, or 0, if only character_size is known
+template<size_t Width>
+static uint64_t hashCharacters(
+	std::string_view bytes,
+	size_t character_size,
+	uint64_t hash
+)
+{
+	auto size = Width ? Width : character_size;
+	for (size_t i = 0; i + size <= bytes.size(); i += size)
+	{
+		uint64_t value = 0;
+		for (size_t j = 0; j < size; ++j)
+		{
+			value = value << 8 | static_cast<uint8_t>(bytes[i + j]);
+		}
+		hash = (hash ^ value) * 0x100000001B3;
+	}
+	return hash;
+}
+
 #define BENCHMARK_LANGUAGE(name) \
 	static void name(benchmark::State& state) \
 	{ \
@@ -35,7 +119,289 @@ using namespace unicode;
 			benchmark::DoNotOptimize(c); \
 		} \
 	} \
-	BENCHMARK(name);
+	BENCHMARK(name); \
+	static void name ## Layout(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		for (auto _ : state) \
+		{ \
+			auto layout = layout::of(content); \
+			benchmark::DoNotOptimize(layout); \
+		} \
+		state.SetBytesProcessed(state.iterations() * content.size()); \
+	} \
+	BENCHMARK(name ## Layout); \
+	static void name ## ValidatedLayout(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		for (auto _ : state) \
+		{ \
+			if (state.range(0) == 0) \
+			{ \
+				auto view = string_view::from_checked(content); \
+				benchmark::DoNotOptimize(view); \
+				continue; \
+			} \
+			/* Separate validation pass, followed by splitting */ \
+			bool valid = true; \
+			for (size_t i = 0; i < content.size() && valid;) \
+			{ \
+				auto size = utf8::decode(std::string_view(content).substr(i)).size; \
+				valid = size != 0; \
+				i += size; \
+			} \
+			benchmark::DoNotOptimize(valid); \
+			string_view view = content; \
+			benchmark::DoNotOptimize(view); \
+		} \
+		state.SetBytesProcessed(state.iterations() * content.size()); \
+	} \
+	BENCHMARK(name ## ValidatedLayout)->ArgName("separate")->Arg(0)->Arg(1); \
+	static void name ## Lines(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto lines = splitLines(content); \
+		for (auto _ : state) \
+		{ \
+			for (auto line : lines) \
+			{ \
+				string_view unicode = line; \
+				benchmark::DoNotOptimize(unicode); \
+			} \
+		} \
+		state.SetItemsProcessed(state.iterations() * lines.size()); \
+	} \
+	BENCHMARK(name ## Lines); \
+	static void name ## Words(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto words = splitWords(content); \
+		for (auto _ : state) \
+		{ \
+			for (auto word : words) \
+			{ \
+				string_view unicode = word; \
+				benchmark::DoNotOptimize(unicode); \
+			} \
+		} \
+		state.SetItemsProcessed(state.iterations() * words.size()); \
+	} \
+	BENCHMARK(name ## Words); \
+	static void name ## WordsCached(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto words = splitWords(content); \
+		layout_cache cache; \
+		for (auto _ : state) \
+		{ \
+			for (auto word : words) \
+			{ \
+				string_view unicode(word, cache); \
+				benchmark::DoNotOptimize(unicode); \
+			} \
+		} \
+		state.SetItemsProcessed(state.iterations() * words.size()); \
+	} \
+	BENCHMARK(name ## WordsCached); \
+	static void name ## Slices(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		string_view unicode = content; \
+		std::vector<std::pair<size_t, size_t>> words; \
+		for (size_t i = 0, start = 0; i <= unicode.size(); ++i) \
+		{ \
+			if (i < unicode.size() && unicode[i] != " " && unicode[i] != "\n") \
+			{ \
+				continue; \
+			} \
+			if (i != start) { words.emplace_back(start, i - start); } \
+			start = i + 1; \
+		} \
+		for (auto _ : state) \
+		{ \
+			for (auto [pos, count] : words) \
+			{ \
+				auto slice = unicode.substr(pos, count); \
+				benchmark::DoNotOptimize(slice); \
+			} \
+		} \
+		state.SetItemsProcessed(state.iterations() * words.size()); \
+	} \
+	BENCHMARK(name ## Slices); \
+	static void name ## Compare(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto lines = splitLines(content); \
+		auto &coll = collator::cached(); \
+		for (auto _ : state) \
+		{ \
+			for (size_t i = 1; i < lines.size(); ++i) \
+			{ \
+				auto res = coll.compare(lines[i - 1], lines[i]); \
+				benchmark::DoNotOptimize(res); \
+			} \
+		} \
+		state.SetItemsProcessed(state.iterations() * (lines.size() - 1)); \
+	} \
+	BENCHMARK(name ## Compare); \
+	static void name ## Sort(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto words = splitWords(content); \
+		auto &coll = collator::cached(); \
+		for (auto _ : state) \
+		{ \
+			auto sorted = words; \
+			std::ranges::sort( \
+				sorted, \
+				[&](auto lhs, auto rhs) { return coll.compare(lhs, rhs) < 0; } \
+			); \
+			benchmark::DoNotOptimize(sorted.data()); \
+		} \
+		state.SetItemsProcessed(state.iterations() * words.size()); \
+	} \
+	BENCHMARK(name ## Sort)->Unit(benchmark::kMillisecond); \
+	static void name ## SortLines(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto lines = repeatLines(content, 1'000'000); \
+		for (auto _ : state) \
+		{ \
+			state.PauseTiming(); \
+			auto sorted = lines; \
+			state.ResumeTiming(); \
+			switch (state.range(0)) \
+			{ \
+			case 0: std::ranges::sort(sorted); break; \
+			case 1: unicode::sort(sorted, {}, execution::seq); break; \
+			case 2: unicode::sort(sorted, {}, execution::par); break; \
+			} \
+			benchmark::DoNotOptimize(sorted.data()); \
+		} \
+		state.SetItemsProcessed(state.iterations() * lines.size()); \
+	} \
+	BENCHMARK(name ## SortLines) \
+		->ArgName("policy")->Arg(0)->Arg(1)->Arg(2) \
+		->Unit(benchmark::kMillisecond)->UseRealTime(); \
+	static void name ## SortWords(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto lines = repeatWords(content, 1'000'000); \
+		for (auto _ : state) \
+		{ \
+			state.PauseTiming(); \
+			auto sorted = lines; \
+			state.ResumeTiming(); \
+			switch (state.range(0)) \
+			{ \
+			case 0: std::ranges::sort(sorted); break; \
+			case 1: unicode::sort(sorted, {}, execution::seq); break; \
+			case 2: unicode::sort(sorted, {}, execution::par); break; \
+			} \
+			benchmark::DoNotOptimize(sorted.data()); \
+		} \
+		state.SetItemsProcessed(state.iterations() * lines.size()); \
+	} \
+	BENCHMARK(name ## SortWords) \
+		->ArgName("policy")->Arg(0)->Arg(1)->Arg(2) \
+		->Unit(benchmark::kMillisecond)->UseRealTime(); \
+	static void name ## Memory(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto lines = splitLines(content); \
+		size_t bytes = 0; \
+		for (auto _ : state) \
+		{ \
+			bytes = 0; \
+			for (auto line : lines) \
+			{ \
+				bytes += sizeof(string_view) + layout::of(line).allocated_bytes(); \
+			} \
+		} \
+		state.counters["bytes_per_view"] = double(bytes) / lines.size(); \
+		state.counters["overhead"] = double(bytes) / content.size(); \
+	} \
+	BENCHMARK(name ## Memory); \
+	static void name ## BatchLayout(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		auto words = splitWords(content); \
+		for (auto _ : state) \
+		{ \
+			if (state.range(0) == 0) \
+			{ \
+				auto batch = layout::of_batch(words); \
+				benchmark::DoNotOptimize(batch); \
+				continue; \
+			} \
+			/* Layout of each string on its own */ \
+			std::vector<layout> layouts; \
+			layouts.reserve(words.size()); \
+			for (auto word : words) { layouts.push_back(layout::of(word)); } \
+			benchmark::DoNotOptimize(layouts); \
+		} \
+		state.SetItemsProcessed(state.iterations() * words.size()); \
+	} \
+	BENCHMARK(name ## BatchLayout)->ArgName("loop")->Arg(0)->Arg(1); \
+	static void name ## BlockHash(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		string_view unicode = content; \
+		for (auto _ : state) \
+		{ \
+			uint64_t hash = 0xCBF29CE484222325; \
+			if (state.range(0) == 0) \
+			{ \
+				unicode.visit_blocks([&]<size_t W>(fixed_width_span<W> span) \
+				{ \
+					hash = hashCharacters<W>( \
+						span.bytes, span.character_size, hash \
+					); \
+				}); \
+			} \
+			else \
+			{ \
+				/* Size of characters is known only at runtime */ \
+				unicode.for_each_block([&](const character_run &run) \
+				{ \
+					hash = hashCharacters<0>( \
+						run.bytes, run.character_size, hash \
+					); \
+				}); \
+			} \
+			benchmark::DoNotOptimize(hash); \
+		} \
+		state.SetItemsProcessed(state.iterations() * unicode.size()); \
+	} \
+	BENCHMARK(name ## BlockHash)->ArgName("runtime_width")->Arg(0)->Arg(1); \
+	static void name ## Histogram(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		string_view unicode = content; \
+		for (auto _ : state) \
+		{ \
+			std::unordered_map< \
+				character_view, size_t, character_hash, character_equal \
+			> histogram; \
+			for (auto c : unicode) { ++histogram[c]; } \
+			benchmark::DoNotOptimize(histogram); \
+		} \
+		state.SetItemsProcessed(state.iterations() * unicode.size()); \
+	} \
+	BENCHMARK(name ## Histogram); \
+	static void name ## HistogramWithCollator(benchmark::State& state) \
+	{ \
+		auto content = readFile("./data/" #name "/wiki.txt"); \
+		string_view unicode = content; \
+		for (auto _ : state) \
+		{ \
+			std::map<character_view, size_t> histogram; \
+			for (auto c : unicode) { ++histogram[c]; } \
+			benchmark::DoNotOptimize(histogram); \
+		} \
+		state.SetItemsProcessed(state.iterations() * unicode.size()); \
+	} \
+	BENCHMARK(name ## HistogramWithCollator);
 
 /* 1-st type of texts */
 BENCHMARK_LANGUAGE(english)
@@ -1,8 +1,10 @@
 #pragma once
 
+#include <cassert>
 #include <string_view>
 
 #include "unicode/comparable_interface.hpp"
+#include "unicode/utf8/normalize.hpp"
 
 namespace unicode
 {
@@ -15,5 +17,92 @@ class character_view
 public:
 	explicit character_view(std::string_view bytes) : std::string_view(bytes) {}
 };
+
+/// Checks, that characters are canonically equivalent, i.e. have same NFC.
+/// It's stricter than operator==, that uses collator and also treats
+/// as equal characters, that differ only by ignorable code points.
+/// Use it together with character_hash in hashed containers
+struct character_equal
+{
+	bool operator()(
+		const character_view &lhs, 
+		const character_view &rhs
+	) const noexcept
+	{
+		return utf8::canonically_equal(lhs, rhs);
+	}
+};
+
+/// Hash of NFC form of character, so canonically equivalent 
+/// characters, like "é" and "e\u0301", have same hash.
+/// It's consistent with character_equal, but not with operator==
+struct character_hash
+{
+	size_t operator()(const character_view &c) const noexcept
+	{
+		return utf8::canonical_hash(c);
+	}
+};
+
+/// Consecutive characters with same size
+struct character_run
+{
+	/// Bytes of characters
+	std::string_view bytes;
+	/// Size of characters in bytes
+	size_t character_size = 0;
+
+	/// Get number of characters
+	size_t size() const noexcept { return bytes.size() / character_size; }
+
+	/// Get character by index
+	character_view operator[](size_t index) const noexcept
+	{
+		assert(index < size() && "out of range");
+		return character_view(
+			bytes.substr(index * character_size, character_size)
+		);
+	}
+};
+
+/// Width of fixed_width_span, which characters have size,
+/// that is known only at runtime
+inline constexpr size_t dynamic_width = 0;
+
+/// Consecutive characters of Width bytes each, 
+/// that are single code points.
+/// Width is known at compile time, so loops over characters 
+/// are unrolled and vectorized by compiler
+template<size_t Width>
+struct fixed_width_span
+{
+	/// Size of characters in bytes
+	static constexpr size_t character_size = Width;
+
+	/// Bytes of characters
+	std::string_view bytes;
+
+	/// Get number of characters
+	size_t size() const noexcept { return bytes.size() / Width; }
+
+	/// Get pointer to the first byte of character by index
+	const char *data(size_t index = 0) const noexcept
+	{
+		return bytes.data() + index * Width;
+	}
+
+	/// Get character by index
+	character_view operator[](size_t index) const noexcept
+	{
+		assert(index < size() && "out of range");
+		return character_view(std::string_view(data(index), Width));
+	}
+};
+
+/// Consecutive characters with same size, that is known only at runtime.
+/// Characters may be grapheme clusters of several code points,
+/// like "e\u0301" or "\r\n", of any size
+template<>
+struct fixed_width_span<dynamic_width> : character_run {};
 	
 } // namespace unicode
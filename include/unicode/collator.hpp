@@ -0,0 +1,99 @@
+#pragma once
+
+#include <compare>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace unicode
+{
+
+/// Strength of locale comparison
+enum class collation_strength
+{
+	/// Compare base letters only
+	primary,
+	/// Compare base letters and accents
+	secondary,
+	/// Compare base letters, accents and case
+	tertiary,
+	/// Also distinguish characters ignored at lower levels
+	quaternary,
+	/// Also distinguish canonically equivalent strings by code points
+	identical
+};
+
+/// Compares UTF-8 strings with rules of some locale
+class collator
+{
+public:
+	/// Create collator for locale. Empty locale means default locale
+	explicit collator(
+		std::string_view locale = {},
+		collation_strength strength = collation_strength::tertiary
+	) noexcept;
+
+	collator(collator &&) noexcept;
+	collator &operator=(collator &&) noexcept;
+	~collator();
+
+	/// Get collator cached by current thread
+	/// @note Reference is valid until next call to invalidate_cache()
+	static const collator &cached(
+		std::string_view locale = {},
+		collation_strength strength = collation_strength::tertiary
+	) noexcept;
+
+	/// Drop collators cached by all threads.
+	/// Must be called after change of default locale
+	static void invalidate_cache() noexcept;
+
+	/// Compare two UTF-8 strings
+	std::strong_ordering compare(
+		std::string_view lhs,
+		std::string_view rhs
+	) const noexcept;
+
+	/// Check that two UTF-8 strings are equal.
+	/// Faster than compare() for byte-identical and ASCII strings
+	bool equal(
+		std::string_view lhs,
+		std::string_view rhs
+	) const noexcept;
+
+	/// Are printable ASCII strings compared without ICU?
+	/// @note False for locales that tailor ASCII letters, 
+	/// like "cs", "da", "tr", and for numeric ordering
+	bool has_ascii_fast_path() const noexcept;
+
+	/// Write sort key of UTF-8 string to buffer, if it fits.
+	/// @return Size of key, including terminating zero, or 0 on error
+	size_t write_sort_key(
+		std::string_view string,
+		uint8_t *buffer,
+		size_t capacity
+	) const noexcept;
+
+	/// Get name of locale, empty for default locale
+	const std::string &locale() const noexcept { return locale_name; }
+
+	/// Get strength of comparison
+	collation_strength strength() const noexcept { return level; }
+
+	/// Was collator created successfully?
+	explicit operator bool() const noexcept { return impl != nullptr; }
+
+private:
+	/// ICU related state
+	struct implementation;
+
+	/// Name of locale
+	std::string locale_name;
+	/// Strength of comparison
+	collation_strength level;
+	/// ICU related state. Null, if collator wasn't created
+	std::unique_ptr<implementation> impl;
+};
+
+} // namespace unicode
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "unicode/utf8/compare.hpp"
+#include "unicode/sort_key.hpp"
 
 namespace unicode
 {
@@ -11,7 +12,9 @@ struct comparable_interface
 {
 	bool operator==(const CRTP& other) const noexcept
 	{
-		return (*this <=> other) == 0;
+		return utf8::equal(
+			static_cast<const CRTP &>(*this), other
+		);
 	}
 
 	auto operator<=>(const CRTP& other) const noexcept
@@ -20,6 +23,16 @@ struct comparable_interface
 			static_cast<const CRTP &>(*this), other
 		);
 	}
+
+	/// Get collation sort key
+	unicode::sort_key sort_key(
+		const collator &coll = collator::cached()
+	) const noexcept
+	{
+		return unicode::sort_key(
+			std::string_view(static_cast<const CRTP &>(*this)), coll
+		);
+	}
 };
 
 } // namespace unicode
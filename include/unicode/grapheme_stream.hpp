@@ -0,0 +1,121 @@
+#pragma once
+
+#include <cassert>
+#include <concepts>
+#include <string>
+#include <string_view>
+
+#include "unicode/character_view.hpp"
+#include "unicode/layout.hpp"
+
+namespace unicode
+{
+
+/// Splits text into characters, while it arrives by chunks of any size.
+///
+/// Chunks may split UTF-8 sequences and grapheme clusters.
+/// Characters are emitted as soon as following bytes can't change them.
+/// Only the tail of text after the last such boundary is kept,
+/// which is usually the last character
+class grapheme_stream
+{
+public:
+	/// Add chunk of text, emitting complete characters to consumer.
+	/// Consumer is called with every character_run, 
+	/// which is valid only during the call
+	template<std::invocable<const character_run &> Consumer>
+	void push(std::string_view chunk, Consumer &&consumer)
+	{
+		emit(prepare(chunk, false), consumer);
+	}
+
+	/// Finish text, emitting remaining characters to consumer
+	template<std::invocable<const character_run &> Consumer>
+	void finish(Consumer &&consumer)
+	{
+		emit(prepare({}, true), consumer);
+	}
+
+	/// Add chunk of text, calling function for every complete character
+	template<std::invocable<character_view> Function>
+	void push_characters(std::string_view chunk, Function &&function)
+	{
+		push(chunk, for_each_character(function));
+	}
+
+	/// Finish text, calling function for every remaining character
+	template<std::invocable<character_view> Function>
+	void finish_characters(Function &&function)
+	{
+		finish(for_each_character(function));
+	}
+
+	/// Get number of emitted characters
+	size_t characters() const noexcept { return emitted.characters; }
+
+	/// Get number of emitted bytes
+	size_t bytes() const noexcept { return emitted.bytes; }
+
+	/// Get number of bytes, waiting for following chunks
+	size_t pending_bytes() const noexcept { return carry.size(); }
+
+private:
+	/// Text, which characters aren't emitted yet
+	std::string carry;
+	/// Layout of text, that is split during current call
+	unicode::layout blocks;
+	/// Number of emitted characters and bytes
+	layout_progress emitted;
+
+	/// Text to emit characters from
+	struct pending_text
+	{
+		/// Bytes of text
+		std::string_view bytes;
+		/// Number of complete characters at the beginning of text
+		size_t characters = 0;
+		/// Number of bytes of complete characters
+		size_t complete_bytes = 0;
+	};
+
+	/// Split carried text with chunk into characters
+	pending_text prepare(std::string_view chunk, bool last) noexcept;
+
+	/// Keep the rest of text for following chunks
+	void keep_tail(const pending_text &text);
+
+	/// Call consumer for runs of complete characters
+	template<typename Consumer>
+	void emit(const pending_text &text, Consumer &consumer)
+	{
+		for (size_t i = 0; i < blocks.size(); ++i)
+		{
+			auto begin = blocks.offset(i);
+			if (begin >= text.characters) { break; }
+
+			auto end = i + 1 < blocks.size() ?
+				std::min(blocks.offset(i + 1), text.characters) :
+				text.characters;
+			auto block = blocks[i];
+			consumer(character_run{
+				.bytes = text.bytes.substr(
+					block.byte_offset, (end - begin) * block.character_size
+				),
+				.character_size = block.character_size
+			});
+		}
+		keep_tail(text);
+	}
+
+	/// Get consumer, that calls function for every character of run
+	template<typename Function>
+	static auto for_each_character(Function &function)
+	{
+		return [&function](const character_run &run)
+		{
+			for (size_t i = 0; i < run.size(); ++i) { function(run[i]); }
+		};
+	}
+};
+
+} // namespace unicode
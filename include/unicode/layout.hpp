@@ -1,10 +1,20 @@
 #pragma once
 
+#include <algorithm>
+#include <bit>
 #include <cassert>
-#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <memory_resource>
+#include <span>
 #include <string_view>
+#include <vector>
 
-#include "unicode/utility/sorted_vector.hpp"
+#include "unicode/metrics.hpp"
 
 namespace unicode
 {
@@ -18,24 +28,750 @@ struct block
 	size_t byte_offset = 0;
 };
 
-/// Unicode string layout
-struct layout
+/// Range of bytes inside of string
+struct byte_range
+{
+	/// Offset of the first byte
+	size_t offset = 0;
+	/// Number of bytes
+	size_t size = 0;
+};
+
+/// Block, found inside of layout
+struct block_position
+{
+	/// Index of block
+	size_t index = 0;
+	/// Offset of the first character of block
+	size_t offset = 0;
+	/// Found block
+	unicode::block block;
+};
+
+/// Way of storing layout
+enum class layout_strategy
+{
+	/// Choose strategy by number of blocks per character
+	automatic,
+	/// Store blocks of characters with same size
+	blocks,
+	/// Store size of each character and byte offsets of every
+	/// sample_size characters. Smaller and faster for text, 
+	/// that changes character size every few characters
+	sampled
+};
+
+/// Runs task, possibly on another thread
+using executor = std::function<void(std::function<void()> task)>;
+
+class layout_batch;
+
+/// Unicode string layout.
+///
+/// Blocks are stored as struct of arrays inside of one buffer.
+/// Integers are 16, 32 or 64 bits wide, depending on size of string.
+/// Layouts with few blocks, like ASCII strings, don't allocate memory.
+///
+/// Sampled layouts present each character before the last block 
+/// as a block of one character, followed by the last block.
+/// They turn back into blocks, when they are modified
+class layout
 {
-	/// Character offsets of blocks
-	utility::sorted_vector<size_t> offsets;
-	/// Blocks of consecutive characters with same size
-	std::vector<block> blocks;
+public:
+	/// Empty layout
+	layout() noexcept
+		: width(2), local(true) {}
+	/// Empty layout, that allocates memory from resource
+	explicit layout(std::pmr::memory_resource *resource) noexcept
+		: width(2), local(true), resource(resource) {}
+	/// Empty layout for string with specified size in bytes
+	explicit layout(
+		size_t string_size,
+		std::pmr::memory_resource *resource = 
+			std::pmr::get_default_resource()
+	) noexcept
+		: width(width_for(string_size)), local(true), resource(resource) {}
+
+	/// Copy layout, allocating memory from default resource
+	layout(const layout &other)
+		: layout(other, std::pmr::get_default_resource()) {}
+	/// Copy layout, allocating memory from resource
+	layout(const layout &other, std::pmr::memory_resource *resource);
+	layout(layout &&other) noexcept;
+	layout &operator=(const layout &other);
+	layout &operator=(layout &&other) noexcept;
+	~layout() { deallocate(); }
 
 	/// Get layout of string
+	/// @note Uses layout builder of current thread
 	static layout of(std::string_view bytes) noexcept;
 
+	/// Get layout of string, allocating memory from resource.
+	/// Layouts from monotonic resource can be freed all at once
+	/// @note Uses layout builder of current thread
+	static layout of(
+		std::string_view bytes,
+		std::pmr::memory_resource *resource
+	) noexcept;
+
+	/// Get layout of string, stored with specified strategy
+	/// @note Uses layout builder of current thread
+	static layout of(
+		std::string_view bytes,
+		layout_strategy strategy
+	) noexcept;
+
+	/// Size of chunks for parallel building of layout, in bytes
+	static constexpr size_t default_chunk_size = 1 << 20;
+
+	/// Get layout of string, splitting chunks of string in parallel.
+	/// String is split into chunks at boundaries, that don't depend 
+	/// on surrounding text. Result is the same as of sequential building
+	static layout of(
+		std::string_view bytes, 
+		const executor &executor,
+		size_t chunk_size = default_chunk_size
+	) noexcept;
+
+	/// Get layouts of many short strings, like a column of table.
+	/// Strings are split by one builder, ASCII strings don't need
+	/// splitting, and blocks of all layouts are allocated from one arena
+	/// @note Uses layout builder of current thread
+	static layout_batch of_batch(
+		std::span<const std::string_view> strings
+	) noexcept;
+
+	/// Get number of blocks
+	size_t size() const noexcept { return count; }
+
+	/// Is there no blocks?
+	[[nodiscard]]
+	bool empty() const noexcept { return count == 0; }
+
+	/// Get offset of the first character of block
+	size_t offset(size_t block_index) const noexcept
+	{
+		assert(block_index < count && "out of range");
+		return sampled ? block_index : load(offsets, block_index);
+	}
+
+	/// Get size of characters inside of block
+	size_t character_size(size_t block_index) const noexcept
+	{
+		assert(block_index < count && "out of range");
+		if (!sampled) { return load(character_sizes, block_index); }
+
+		return block_index + 1 < count ? 
+			size_t(sampled_sizes()[block_index]) : 
+			load_value(data());
+	}
+
+	/// Get index of the first block after specified one,
+	/// that has different size of characters
+	size_t next_run(size_t block_index) const noexcept
+	{
+		assert(block_index < count && "out of range");
+		if (!sampled || block_index + 1 >= count) { return block_index + 1; }
+
+		// Characters before the last block are blocks of sampled layout
+		auto *sizes = sampled_sizes();
+		auto size = sizes[block_index];
+		auto next = block_index + 1;
+		while (next + 1 < count && sizes[next] == size) { ++next; }
+		if (next + 1 == count && load_value(heap.data) == size) { ++next; }
+		return next;
+	}
+
+	/// Get block by index
+	block operator[](size_t block_index) const noexcept
+	{
+		assert(block_index < count && "out of range");
+		if (sampled) { return sampled_block_for(block_index).block; }
+		return block{
+			.character_size = load(character_sizes, block_index),
+			.byte_offset = load(byte_offsets, block_index)
+		};
+	}
+
+	/// Get last block
+	block back() const noexcept { return (*this)[count - 1]; }
+
+	/// Add block to the end of layout
+	/// @warning Block must start after all characters of previous block.
+	/// Sampled layout turns back into blocks
+	void push_back(size_t offset, block block) noexcept;
+
+	/// Remove all blocks
+	void clear() noexcept
+	{
+		deallocate();
+		count = 0;
+	}
+
+	/// Release unused memory, storing layout with specified strategy.
+	/// Large layouts of blocks also build search index 
+	/// for faster block lookup.
+	/// @note Layouts, that can't be sampled, like ones with characters
+	/// larger than 255 bytes, are stored as blocks
+	void shrink_to_fit(
+		layout_strategy strategy = layout_strategy::automatic
+	) noexcept;
+
+	/// Get strategy of stored layout, either blocks or sampled
+	layout_strategy strategy() const noexcept
+	{
+		return sampled ? layout_strategy::sampled : layout_strategy::blocks;
+	}
+
+	/// Remove blocks, that start at or after specified character.
+	/// Sampled layout turns back into blocks
+	void truncate(size_t character_index) noexcept
+	{
+		if (sampled) { unsample(); }
+		count = character_index == 0 ? 0 : upper_bound(character_index - 1);
+		indexed = false;
+	}
+
 	/// Get index of block for specified character
 	size_t block_index_for_character(size_t character_index) const noexcept
 	{
-		auto next = offsets.upper_bound(character_index);
-		assert(next != offsets.begin() && "block not found");
-		return std::distance(offsets.begin(), next) - 1;
+		if (sampled) { return std::min(character_index, count - 1); }
+
+		auto next = upper_bound(character_index);
+		assert(next != 0 && "block not found");
+		return next - 1;
+	}
+
+	/// Get block for specified character
+	block_position block_for_character(
+		size_t character_index
+	) const noexcept
+	{
+		metrics::add(metrics::counter::block_lookups);
+		return block_for(offsets, character_index);
+	}
+
+	/// Get block, that contains specified byte
+	block_position block_for_byte(size_t byte_offset) const noexcept
+	{
+		metrics::add(metrics::counter::byte_lookups);
+		return block_for(byte_offsets, byte_offset);
+	}
+
+	/// Get size of stored integers in bytes
+	size_t integer_width() const noexcept { return width; }
+
+	/// Get resource, that provides memory for blocks
+	std::pmr::memory_resource *memory_resource() const noexcept
+	{
+		return resource;
+	}
+
+	/// Get number of bytes, allocated for blocks
+	size_t allocated_bytes() const noexcept
+	{
+		return local ? 0 : heap_size();
+	}
+
+	/// Does layout have search index over offsets of blocks?
+	bool has_index() const noexcept { return indexed; }
+
+	/// Get size of serialized blocks in bytes
+	size_t serialized_size() const noexcept { return count * 3 * width; }
+
+	/// Write blocks to buffer of serialized_size() bytes 
+	/// as three arrays of integers with integer_width() bytes.
+	/// @note Blocks of sampled layout are written as they are presented,
+	/// so it should be stored as blocks first
+	void serialize(std::byte *buffer) const noexcept;
+
+	/// Read blocks, written by serialize()
+	/// @return Empty layout, if data has wrong size or width
+	static layout deserialize(
+		std::span<const std::byte> data,
+		size_t block_count,
+		size_t integer_width
+	) noexcept;
+
+	/// Layouts are equal, if they have same blocks
+	bool operator==(const layout &other) const noexcept;
+
+private:
+	/// Size of inline storage in bytes
+	static constexpr size_t inline_size = 24;
+	/// Minimal number of blocks for building search index.
+	/// Smaller layouts fit into cache, so binary search is fast enough
+	static constexpr size_t indexed_size = 256;
+	/// Number of characters between byte offsets of sampled layout
+	static constexpr size_t sample_size = 32;
+
+	/// Arrays inside of storage
+	enum array : size_t
+	{
+		/// Character offsets of blocks
+		offsets,
+		/// Offsets of the first bytes of blocks
+		byte_offsets,
+		/// Sizes of characters inside of blocks
+		character_sizes,
+		/// Offsets of blocks in Eytzinger order, starting from index 1.
+		/// Only exists in heap storage with index space
+		search_index
+	};
+	// Heap storage of sampled layout contains size and byte offset
+	// of the last block, byte offsets of every sample_size characters
+	// and sizes of characters before the last block as bytes
+
+	/// Number of blocks
+	size_t count = 0;
+	/// Size of stored integers in bytes
+	uint8_t width;
+	/// Are blocks stored inline?
+	bool local;
+	/// Does heap storage have space for search index?
+	bool index_space = false;
+	/// Is search index up to date?
+	bool indexed = false;
+	/// Is layout sampled? Sampled layout is always stored in heap
+	/// with capacity equal to number of blocks
+	bool sampled = false;
+	union
+	{
+		/// Heap storage
+		struct
+		{
+			/// Storage for blocks
+			std::byte *data;
+			/// Number of blocks, that fit into storage
+			size_t capacity;
+		} heap;
+		/// Inline storage for blocks
+		alignas(8) std::byte inline_data[inline_size];
+	};
+	/// Resource, that provides memory for blocks
+	std::pmr::memory_resource *resource = std::pmr::get_default_resource();
+
+	/// Get the smallest integer width for values up to maximum
+	static constexpr uint8_t width_for(size_t max) noexcept
+	{
+		if (max <= UINT16_MAX) { return 2; }
+		if (max <= UINT32_MAX) { return 4; }
+		return 8;
+	}
+
+	/// Get size of heap storage in bytes
+	static constexpr size_t storage_size(
+		size_t capacity, 
+		uint8_t width, 
+		bool index_space
+	) noexcept
+	{
+		return (3 * capacity + (index_space ? capacity + 1 : 0)) * width;
+	}
+
+	/// Get size of heap storage of sampled layout in bytes
+	static constexpr size_t sampled_storage_size(
+		size_t count,
+		uint8_t width
+	) noexcept
+	{
+		auto characters = count - 1;
+		auto samples = (characters + sample_size - 1) / sample_size;
+		return (2 + samples) * width + characters;
+	}
+
+	/// Get size of heap storage in bytes
+	size_t heap_size() const noexcept
+	{
+		return sampled ? 
+			sampled_storage_size(heap.capacity, width) :
+			storage_size(heap.capacity, width, index_space);
+	}
+
+	/// Get number of blocks, that fit into storage
+	size_t capacity() const noexcept
+	{
+		return local ? inline_size / (3 * width) : heap.capacity;
 	}
+
+	/// Get storage for blocks
+	const std::byte *data() const noexcept
+	{
+		return local ? inline_data : heap.data;
+	}
+	std::byte *data() noexcept
+	{
+		return local ? inline_data : heap.data;
+	}
+
+	/// Load integer from array
+	size_t load(array array, size_t index) const noexcept
+	{
+		return load_value(data() + (array * capacity() + index) * width);
+	}
+
+	/// Load integer with integer width
+	size_t load_value(const std::byte *address) const noexcept
+	{
+		switch (width)
+		{
+		case 2: return load_as<uint16_t>(address);
+		case 4: return load_as<uint32_t>(address);
+		default: return load_as<uint64_t>(address);
+		}
+	}
+
+	/// Store integer to array
+	void store(array array, size_t index, size_t value) noexcept
+	{
+		store_value(
+			data() + (array * capacity() + index) * width, value, width
+		);
+	}
+
+	/// Store integer with specified width
+	static void store_value(
+		std::byte *address, 
+		size_t value, 
+		uint8_t width
+	) noexcept;
+
+	/// Load integer of specific type
+	template<typename T>
+	static size_t load_as(const std::byte *address) noexcept
+	{
+		T value;
+		std::memcpy(&value, address, sizeof(T));
+		return value;
+	}
+
+	/// Get sizes of characters of sampled layout
+	const uint8_t *sampled_sizes() const noexcept
+	{
+		auto characters = count - 1;
+		auto samples = (characters + sample_size - 1) / sample_size;
+		return reinterpret_cast<const uint8_t *>(
+			heap.data + (2 + samples) * width
+		);
+	}
+
+	/// Get block of sampled layout for character.
+	/// Byte offset of character is found from the previous sample 
+	/// by adding sizes of characters after it
+	block_position sampled_block_for(
+		size_t character_index
+	) const noexcept
+	{
+		auto characters = count - 1;
+		if (character_index >= characters)
+		{
+			return {
+				.index = characters,
+				.offset = characters,
+				.block = {
+					.character_size = load_value(heap.data),
+					.byte_offset = load_value(heap.data + width)
+				}
+			};
+		}
+
+		auto *sizes = sampled_sizes();
+		auto sample = character_index / sample_size;
+		auto byte_offset = load_value(heap.data + (2 + sample) * width);
+		for (auto i = sample * sample_size; i < character_index; ++i)
+		{
+			byte_offset += sizes[i];
+		}
+		return {
+			.index = character_index,
+			.offset = character_index,
+			.block = {
+				.character_size = sizes[character_index],
+				.byte_offset = byte_offset
+			}
+		};
+	}
+
+	/// Get block of sampled layout, that contains byte
+	block_position sampled_block_for_byte(size_t byte_offset) const noexcept;
+
+	/// Store blocks as sampled layout, if they can be sampled
+	void sample() noexcept;
+
+	/// Store sampled layout as blocks
+	void unsample() noexcept;
+
+	/// Get index of the first block, that starts after character
+	size_t upper_bound(size_t character_index) const noexcept
+	{
+		switch (width)
+		{
+		case 2: return upper_bound_as<uint16_t>(offsets, character_index);
+		case 4: return upper_bound_as<uint32_t>(offsets, character_index);
+		default: return upper_bound_as<uint64_t>(offsets, character_index);
+		}
+	}
+
+	/// Get index of the first block, that starts after value
+	template<typename T>
+	size_t upper_bound_as(array array, size_t value) const noexcept
+	{
+		if (value >= std::numeric_limits<T>::max()) { return count; }
+		if (count == 0) { return 0; }
+		if (array == offsets && indexed) 
+		{ 
+			return indexed_upper_bound_as<T>(value); 
+		}
+
+		// Branchless binary search
+		auto *values = data() + array * capacity() * sizeof(T);
+		auto *base = values;
+		for (auto length = count; length > 1;)
+		{
+			auto half = length / 2;
+			base = load_as<T>(base + half * sizeof(T)) <= value ? 
+				base + half * sizeof(T) : base;
+			length -= half;
+		}
+		return 
+			(base - values) / sizeof(T) + (load_as<T>(base) <= value);
+	}
+
+	/// Get index of the first block, that starts after value,
+	/// searching for it in Eytzinger order of offsets
+	template<typename T>
+	size_t indexed_upper_bound_as(size_t value) const noexcept
+	{
+		auto *tree = data() + search_index * capacity() * sizeof(T);
+		size_t node = 1;
+		while (node <= count)
+		{
+#if defined(__GNUC__) || defined(__clang__)
+			// Descendants of node, that are few levels below,
+			// are stored in one cache line
+			__builtin_prefetch(
+				reinterpret_cast<const void *>(
+					reinterpret_cast<uintptr_t>(tree) + node * 64
+				)
+			);
+#endif
+			node = 2 * node + (load_as<T>(tree + node * sizeof(T)) <= value);
+		}
+		// Go up to the last node, where search went left
+		node >>= std::countr_one(node) + 1;
+		return node == 0 ? count : sorted_index(node);
+	}
+
+	/// Get index of value in sorted order from its Eytzinger index
+	size_t sorted_index(size_t node) const noexcept
+	{
+		size_t height = std::bit_width(count);
+		size_t depth = std::bit_width(node) - 1;
+		size_t position = node - (size_t(1) << depth);
+
+		// Index in perfect tree of the same height
+		auto index = ((2 * position + 1) << (height - 1 - depth)) - 1;
+		// Nodes, missing from the last level of perfect tree, 
+		// have even indexes
+		auto last_level = count - ((size_t(1) << (height - 1)) - 1);
+		auto missing_before = (index + 1) / 2;
+		return 
+			missing_before > last_level ? 
+				index - (missing_before - last_level) : index;
+	}
+
+	/// Build search index in Eytzinger order of offsets
+	void build_index() noexcept;
+
+	/// Get the last block, that starts before value of array
+	block_position block_for(array array, size_t value) const noexcept
+	{
+		if (sampled)
+		{
+			return array == offsets ? 
+				sampled_block_for(value) : sampled_block_for_byte(value);
+		}
+		switch (width)
+		{
+		case 2: return block_for_as<uint16_t>(array, value);
+		case 4: return block_for_as<uint32_t>(array, value);
+		default: return block_for_as<uint64_t>(array, value);
+		}
+	}
+
+	/// Get the last block, that starts before value of array
+	template<typename T>
+	block_position block_for_as(array array, size_t value) const noexcept
+	{
+		auto next = upper_bound_as<T>(array, value);
+		assert(next != 0 && "block not found");
+
+		auto index = next - 1;
+		auto *address = data() + index * sizeof(T);
+		auto stride = capacity() * sizeof(T);
+		return {
+			.index = index,
+			.offset = load_as<T>(address + offsets * stride),
+			.block = {
+				.character_size = load_as<T>(address + character_sizes * stride),
+				.byte_offset = load_as<T>(address + byte_offsets * stride)
+			}
+		};
+	}
+
+	/// Move blocks to storage with new capacity and integer width
+	void reallocate(
+		size_t new_capacity, 
+		uint8_t new_width, 
+		bool with_index_space = false
+	) noexcept;
+	void reallocate(size_t new_capacity) noexcept
+	{
+		reallocate(new_capacity, width);
+	}
+
+	/// Free heap storage
+	void deallocate() noexcept
+	{
+		if (!local) 
+		{ 
+			resource->deallocate(heap.data, heap_size(), alignof(uint64_t));
+		}
+		local = true;
+		index_space = false;
+		indexed = false;
+		sampled = false;
+	}
+};
+
+/// Progress of incremental layout building
+struct layout_progress
+{
+	/// Number of characters inside of layout
+	size_t characters = 0;
+	/// Number of bytes, covered by layout
+	size_t bytes = 0;
+};
+
+/// Builds layouts of strings, reusing ICU break iterator between calls.
+/// Building needs no ICU setup, except for the first string with
+/// characters, that need full grapheme cluster rules
+class layout_builder
+{
+public:
+	layout_builder() noexcept;
+	layout_builder(layout_builder &&) noexcept;
+	layout_builder &operator=(layout_builder &&) noexcept;
+	~layout_builder();
+
+	/// Get builder of current thread
+	static layout_builder &current() noexcept;
+
+	/// Get layout of string
+	layout build(std::string_view bytes) noexcept;
+
+	/// Get layout of string, allocating memory from resource
+	layout build(
+		std::string_view bytes,
+		std::pmr::memory_resource *resource,
+		layout_strategy strategy = layout_strategy::automatic
+	) noexcept;
+
+	/// Update layout of string, after bytes of range were replaced 
+	/// with new_length bytes. Characters are split again from 
+	/// the last safe boundary before change, until blocks of old layout
+	/// match again. Blocks after that are only shifted.
+	/// Sampled layout is stored as blocks first
+	void update(
+		layout &layout,
+		layout_progress &progress,
+		std::string_view bytes,
+		byte_range changed,
+		size_t new_length
+	) noexcept;
+
+	/// Extend layout of string, until it covers at least specified number
+	/// of bytes. Layout always ends at grapheme cluster boundary, 
+	/// so it may cover a bit more bytes
+	void extend(
+		layout &layout,
+		std::string_view bytes,
+		layout_progress &progress,
+		size_t byte_count
+	) noexcept;
+
+	/// Build layout of string, if it's well-formed UTF-8.
+	/// Bytes are validated in the same pass, that splits them 
+	/// into characters, so valid strings cost no extra pass.
+	/// @return Offset of the first byte of ill-formed sequence,
+	/// or SIZE_MAX, if string is well-formed and layout is built
+	size_t build_checked(std::string_view bytes, layout &layout) noexcept;
+
+private:
+	/// ICU related state
+	struct implementation;
+
+	/// Split bytes into characters, until layout covers at least 
+	/// specified number of bytes. If ill_formed isn't null,
+	/// stops at the first ill-formed sequence and writes its offset
+	void split(
+		layout &layout,
+		std::string_view bytes,
+		layout_progress &progress,
+		size_t byte_count,
+		size_t *ill_formed
+	) noexcept;
+
+	/// ICU related state. Created on first use
+	std::unique_ptr<implementation> impl;
+};
+
+/// Layouts of strings, built by layout::of_batch().
+///
+/// Layouts with few blocks are stored inline, while blocks of others 
+/// are packed into one arena, which is freed with the batch at once.
+/// Storage, that layouts outgrow while they are built, stays in arena.
+/// Layouts, moved out of batch, still use its arena,
+/// so batch must outlive them
+class layout_batch
+{
+public:
+	/// Get number of layouts
+	size_t size() const noexcept { return layouts.size(); }
+
+	/// Is there no layouts?
+	[[nodiscard]]
+	bool empty() const noexcept { return layouts.empty(); }
+
+	/// Get layout of string by its index in batch
+	const layout &operator[](size_t index) const noexcept
+	{
+		assert(index < layouts.size() && "out of range");
+		return layouts[index];
+	}
+	/// Get layout of string by its index in batch
+	layout &operator[](size_t index) noexcept
+	{
+		assert(index < layouts.size() && "out of range");
+		return layouts[index];
+	}
+
+	/// Get iterators over layouts
+	auto begin() const noexcept { return layouts.begin(); }
+	auto end() const noexcept { return layouts.end(); }
+
+	/// Get number of bytes, allocated for blocks of all layouts
+	size_t allocated_bytes() const noexcept { return allocated; }
+
+private:
+	friend class layout;
+
+	/// Memory for blocks of layouts
+	std::unique_ptr<std::pmr::monotonic_buffer_resource> arena;
+	/// Layouts of strings in order of strings
+	std::vector<layout> layouts;
+	/// Number of bytes, allocated for blocks
+	size_t allocated = 0;
 };
 	
 } // namespace unicode
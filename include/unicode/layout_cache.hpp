@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include "unicode/layout.hpp"
+
+namespace unicode
+{
+
+/// Cache of layouts of short strings, shared by many threads.
+/// 
+/// Layouts are stored by hash of string content, together with 
+/// a copy of string, so hash collisions are never returned.
+/// Lookups don't take locks: entries are reference counted 
+/// and freed by the last thread, that uses them.
+/// Memory is bounded by capacity. When all slots of bucket are taken,
+/// the slot, that wasn't used since the last pass of CLOCK hand, 
+/// is replaced.
+/// Slots pack pointer to entry with counter of its readers, so entries 
+/// with addresses above 48 bits, like tagged pointers, aren't cached
+class layout_cache
+{
+public:
+	/// Create cache for up to capacity layouts of strings,
+	/// that are not longer than max_string_size bytes
+	explicit layout_cache(
+		size_t capacity = 4096, 
+		size_t max_string_size = 256
+	) noexcept;
+
+	layout_cache(const layout_cache &) = delete;
+	layout_cache &operator=(const layout_cache &) = delete;
+	~layout_cache();
+
+	/// Get cache, shared by whole process
+	static layout_cache &shared() noexcept;
+
+	/// Get layout of string. 
+	/// On hit, layout is copied from cache without splitting string.
+	/// On miss, layout is built and stored, if cache accepts string
+	layout of(std::string_view bytes) noexcept;
+
+	/// Are layouts of string stored in cache?
+	/// Strings longer than max_string_size() and ASCII strings
+	/// are always split, because splitting them is faster
+	bool accepts(std::string_view bytes) const noexcept;
+
+	/// Get maximal number of cached layouts
+	size_t capacity() const noexcept { return slot_count; }
+
+	/// Get maximal size of cached strings
+	size_t max_string_size() const noexcept { return max_size; }
+
+	/// Drop all cached layouts.
+	/// Threads, that are copying them right now, aren't affected
+	void clear() noexcept;
+
+private:
+	/// Cached layout together with its string
+	struct entry;
+	/// Reference to entry with counter of threads, that are reading it
+	struct slot;
+
+	/// Number of slots, power of two
+	size_t slot_count = 0;
+	/// Maximal size of cached strings
+	size_t max_size = 0;
+	/// Slots of all buckets
+	std::unique_ptr<slot[]> slots;
+};
+
+} // namespace unicode
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <system_error>
+
+#include "unicode/string_view.hpp"
+
+namespace unicode
+{
+
+/// Reads file by lines, that are split into characters in background.
+///
+/// One thread reads file by large chunks, while pool of workers
+/// splits lines of already read chunks into characters,
+/// so reading of file overlaps with building layouts of its lines.
+/// Lines are read in order of file and don't include delimiter
+class line_reader
+{
+public:
+	/// Options of reading
+	struct options
+	{
+		/// Size of chunks, that are read at once.
+		/// Chunks are extended for lines, that are longer
+		size_t chunk_size = size_t(4) << 20;
+		/// Byte, that ends lines
+		char delimiter = '\n';
+		/// Number of threads, that split lines into characters.
+		/// 0 is for one less than number of hardware threads
+		size_t workers = 0;
+		/// Maximal number of chunks, that are read, but not consumed yet
+		size_t depth = 4;
+	};
+
+	/// Open file and start reading it
+	explicit line_reader(const std::filesystem::path &path);
+	/// Open file and start reading it with options
+	line_reader(const std::filesystem::path &path, options settings);
+
+	line_reader(line_reader &&other) noexcept;
+	line_reader &operator=(line_reader &&other) noexcept;
+	/// Stop reading and wait for background threads
+	~line_reader();
+
+	/// Get next line.
+	/// @return nullptr after the last line, or after the last line,
+	/// that was read before error. Line is valid until the next call
+	const unicode::string_view *next();
+
+	/// Get error of opening or reading file.
+	/// Lines may end early because of error, so it's checked 
+	/// after next() returns nullptr
+	std::error_code error() const;
+
+	/// Was file opened successfully?
+	explicit operator bool() const noexcept { return pipeline != nullptr; }
+
+	/// Input iterator over lines, that calls next()
+	class iterator
+	{
+	public:
+		using iterator_category = std::input_iterator_tag;
+		using value_type = unicode::string_view;
+		using difference_type = std::ptrdiff_t;
+
+		iterator() = default;
+		explicit iterator(line_reader &reader)
+			: reader(&reader), line(reader.next()) {}
+
+		const unicode::string_view &operator*() const noexcept
+		{
+			return *line;
+		}
+		const unicode::string_view *operator->() const noexcept
+		{
+			return line;
+		}
+
+		iterator &operator++()
+		{
+			line = reader->next();
+			return *this;
+		}
+		void operator++(int) { ++*this; }
+
+		bool operator==(std::default_sentinel_t) const noexcept
+		{
+			return line == nullptr;
+		}
+
+	private:
+		/// Reader of lines
+		line_reader *reader = nullptr;
+		/// Current line
+		const unicode::string_view *line = nullptr;
+	};
+
+	/// Get iterator at the next line. Lines can be iterated only once
+	iterator begin() { return iterator(*this); }
+	std::default_sentinel_t end() const noexcept { return {}; }
+
+private:
+	/// Chunks, shared with background threads
+	class pipeline_state;
+
+	/// Chunks of file, that are read and split in background
+	std::unique_ptr<pipeline_state> pipeline;
+	/// Error of opening file
+	std::error_code open_error;
+};
+
+} // namespace unicode
@@ -0,0 +1,187 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "unicode/layout.hpp"
+#include "unicode/string_view.hpp"
+#include "unicode/utf8/grapheme.hpp"
+
+namespace unicode
+{
+
+/// Bytes of string literal, that can be passed as template argument
+template<size_t N>
+struct fixed_string
+{
+	/// Bytes of literal with terminating zero
+	char bytes[N] = {};
+
+	consteval fixed_string(const char (&literal)[N]) noexcept
+	{
+		std::copy_n(literal, N, bytes);
+	}
+
+	/// Get bytes of literal without terminating zero
+	constexpr std::string_view view() const noexcept
+	{
+		return std::string_view(bytes, N - 1);
+	}
+};
+
+/// Call function with size of each character of string.
+/// Only strings of standalone code points, CR and CR LF are split,
+/// because they don't need full grapheme cluster rules.
+/// @return False, if string has other code points or ill-formed sequences
+template<typename Function>
+constexpr bool split_standalone(std::string_view bytes, Function &&function)
+{
+	for (size_t position = 0; position < bytes.size();)
+	{
+		auto rest = bytes.substr(position);
+		size_t size = rest.starts_with("\r\n") ? 2 : rest.front() == '\r';
+		if (size == 0)
+		{
+			auto codepoint = utf8::decode(rest);
+			if (codepoint.size == 0 || !utf8::is_standalone(codepoint.value))
+			{
+				return false;
+			}
+			size = codepoint.size;
+		}
+		function(size);
+		position += size;
+	}
+	return true;
+}
+
+/// Layout of string literal, computed at compile time
+template<fixed_string Literal>
+struct literal_layout
+{
+	/// Bytes of literal
+	static constexpr std::string_view bytes = Literal.view();
+
+	/// Number of blocks, that start where character size changes
+	static constexpr size_t block_count = []
+	{
+		size_t count = 0, previous = 0;
+		auto computed = split_standalone(bytes, [&](size_t size)
+		{
+			count += size != previous;
+			previous = size;
+		});
+		return computed ? count : 0;
+	}();
+
+	/// Was layout computed at compile time?
+	/// Literals with complex clusters are split at runtime
+	static constexpr bool computed =
+		split_standalone(bytes, [](size_t) {});
+
+	/// Block together with offset of its first character
+	struct offset_block
+	{
+		/// Offset of the first character
+		size_t offset = 0;
+		/// Block of characters
+		unicode::block block;
+	};
+
+	/// Blocks of literal
+	static constexpr std::array<offset_block, block_count> blocks = []
+	{
+		std::array<offset_block, block_count> blocks{};
+		if (!computed) { return blocks; }
+
+		size_t count = 0, previous = 0, characters = 0, byte_offset = 0;
+		split_standalone(bytes, [&](size_t size)
+		{
+			if (size != previous)
+			{
+				blocks[count++] = {
+					.offset = characters,
+					.block = {
+						.character_size = size,
+						.byte_offset = byte_offset
+					}
+				};
+				previous = size;
+			}
+			++characters;
+			byte_offset += size;
+		});
+		return blocks;
+	}();
+
+	/// Number of characters in literal
+	static constexpr size_t characters = []
+	{
+		size_t count = 0;
+		split_standalone(bytes, [&](size_t) { ++count; });
+		return count;
+	}();
+
+	/// Size of integers of layout
+	static constexpr size_t integer_width = 
+		bytes.size() <= UINT16_MAX ? 2 : bytes.size() <= UINT32_MAX ? 4 : 8;
+
+	/// Blocks, serialized like layout::serialize() does
+	static constexpr auto serialized = []
+	{
+		std::array<std::byte, 3 * block_count * integer_width> result{};
+		auto store = [&](size_t array, size_t index, size_t value)
+		{
+			auto *address = 
+				result.data() + (array * block_count + index) * integer_width;
+			for (size_t i = 0; i < integer_width; ++i)
+			{
+				auto byte = std::endian::native == std::endian::little ? 
+					i : integer_width - 1 - i;
+				address[byte] = static_cast<std::byte>(value >> (8 * i));
+			}
+		};
+		for (size_t i = 0; i < block_count; ++i)
+		{
+			store(0, i, blocks[i].offset);
+			store(1, i, blocks[i].block.byte_offset);
+			store(2, i, blocks[i].block.character_size);
+		}
+		return result;
+	}();
+};
+
+namespace literals
+{
+
+/// View over characters of literal, which layout is computed
+/// at compile time. Creating view only copies serialized blocks,
+/// unless literal has characters, that need full grapheme cluster rules
+template<fixed_string Literal>
+unicode::string_view operator""_usv()
+{
+	using literal = literal_layout<Literal>;
+	if constexpr (!literal::computed)
+	{
+		return unicode::string_view(literal::bytes);
+	}
+	else
+	{
+		return unicode::string_view(
+			literal::bytes,
+			layout::deserialize(
+				literal::serialized, 
+				literal::block_count, 
+				literal::integer_width
+			)
+		);
+	}
+}
+
+} // namespace literals
+
+} // namespace unicode
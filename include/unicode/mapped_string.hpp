@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <memory>
+#include <string_view>
+
+#include "unicode/string_view.hpp"
+
+namespace unicode
+{
+
+/// Read-only file, mapped to memory and viewed as unicode string.
+///
+/// Layout can be saved to sidecar file next to the string file,
+/// so reopening the file doesn't split it into characters again.
+/// Sidecar is used only if its version and checksums match
+class mapped_string
+{
+public:
+	/// Map file to memory. Layout is loaded from sidecar file, 
+	/// if it's up to date, or built otherwise
+	explicit mapped_string(const std::filesystem::path &path) noexcept;
+
+	mapped_string(mapped_string &&other) noexcept;
+	mapped_string &operator=(mapped_string &&other) noexcept;
+	~mapped_string();
+
+	/// Get path of sidecar file with layout of string file
+	static std::filesystem::path sidecar_path(
+		const std::filesystem::path &path
+	);
+
+	/// Save layout to sidecar file
+	/// @return false, if file couldn't be written
+	bool save_layout() const noexcept;
+
+	/// Was layout loaded from sidecar file?
+	bool is_layout_loaded() const noexcept { return layout_loaded; }
+
+	/// Get view over string
+	const unicode::string_view &view() const noexcept { return string; }
+	operator const unicode::string_view &() const noexcept { return string; }
+
+	/// Get bytes of file
+	std::string_view bytes() const noexcept { return string; }
+
+	/// Get path of file
+	const std::filesystem::path &path() const noexcept { return file_path; }
+
+	/// Was file mapped successfully?
+	explicit operator bool() const noexcept { return mapped; }
+
+private:
+	/// Memory of mapped file
+	class mapping;
+
+	/// Path of file
+	std::filesystem::path file_path;
+	/// Memory of string file
+	std::unique_ptr<mapping> memory;
+	/// View over mapped memory
+	unicode::string_view string;
+	/// Was file mapped successfully?
+	bool mapped = false;
+	/// Was layout loaded from sidecar file?
+	bool layout_loaded = false;
+};
+
+} // namespace unicode
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/// Counters of hot paths of library.
+/// They are compiled only with UNICODE_METRICS CMake option,
+/// otherwise all functions are empty and snapshot() returns zeroes
+namespace unicode::metrics
+{
+
+/// Was library built with metrics?
+inline constexpr bool enabled =
+#if defined(UNICODE_METRICS)
+	true;
+#else
+	false;
+#endif
+
+/// Events, counted by library
+enum class counter : size_t
+{
+	/// Views constructed over bytes
+	views,
+	/// Bytes, split into characters
+	bytes_segmented,
+	/// Bytes, split into characters by ICU break iterator
+	bytes_segmented_by_icu,
+	/// Searches of block by index of character
+	block_lookups,
+	/// Searches of block by byte offset
+	byte_lookups,
+	/// Layouts, copied from layout_cache
+	layout_cache_hits,
+	/// Layouts, built on layout_cache miss
+	layout_cache_misses,
+	/// Collators created
+	collators_created,
+	/// Calls to collator::compare() and collator::equal()
+	comparisons,
+	/// Comparisons of byte-identical strings
+	comparisons_identical,
+	/// Comparisons of printable ASCII strings by weights
+	comparisons_ascii,
+	/// Comparisons by ICU
+	comparisons_icu,
+	/// Normalization checks, that passed without ICU
+	normalizations_fast,
+	/// Normalization checks and conversions by ICU
+	normalizations_icu,
+	/// Nanoseconds spent in ICU segmentation, collation and normalization
+	icu_nanoseconds,
+	/// Number of counters
+	count
+};
+
+/// Number of buckets in histogram of blocks per layout.
+/// Bucket 0 counts empty layouts, bucket i counts layouts
+/// with [2^(i-1), 2^i) blocks, the last one counts all bigger layouts
+inline constexpr size_t histogram_buckets = 24;
+
+/// Values of counters, summed over all threads
+struct counters
+{
+	/// Values of counters by event
+	std::array<uint64_t, static_cast<size_t>(counter::count)> values{};
+	/// Histogram of blocks per complete layout
+	std::array<uint64_t, histogram_buckets> blocks_per_layout{};
+
+	/// Get value of counter
+	uint64_t operator[](counter c) const noexcept
+	{
+		return values[static_cast<size_t>(c)];
+	}
+};
+
+/// Get counters, summed over all threads, since the last reset()
+counters snapshot() noexcept;
+
+/// Start counting from zero
+void reset() noexcept;
+
+/// Get histogram bucket for number of blocks
+constexpr size_t bucket_of(size_t blocks) noexcept
+{
+	size_t bucket = 0;
+	for (; blocks != 0 && bucket + 1 < histogram_buckets; blocks >>= 1)
+	{
+		++bucket;
+	}
+	return bucket;
+}
+
+#if defined(UNICODE_METRICS)
+
+/// Counters of single thread.
+/// Only owner thread writes them, so relaxed load and store are enough
+struct thread_counters
+{
+	/// Values of counters by event
+	std::array<std::atomic<uint64_t>, static_cast<size_t>(counter::count)> 
+		values{};
+	/// Histogram of blocks per complete layout
+	std::array<std::atomic<uint64_t>, histogram_buckets> blocks_per_layout{};
+
+	/// Register counters of thread
+	thread_counters() noexcept;
+	/// Move counters of finished thread to shared total
+	~thread_counters();
+
+	/// Increase value without read-modify-write instruction
+	static void increase(std::atomic<uint64_t> &value, uint64_t by) noexcept
+	{
+		value.store(
+			value.load(std::memory_order_relaxed) + by, 
+			std::memory_order_relaxed
+		);
+	}
+};
+
+/// Get counters of current thread
+thread_counters &local() noexcept;
+
+#endif
+
+/// Add value to counter of current thread
+inline void add(
+	[[maybe_unused]] counter c, 
+	[[maybe_unused]] uint64_t value = 1
+) noexcept
+{
+#if defined(UNICODE_METRICS)
+	thread_counters::increase(local().values[static_cast<size_t>(c)], value);
+#endif
+}
+
+/// Count complete layout with number of blocks
+inline void add_layout([[maybe_unused]] size_t blocks) noexcept
+{
+#if defined(UNICODE_METRICS)
+	thread_counters::increase(local().blocks_per_layout[bucket_of(blocks)], 1);
+#endif
+}
+
+/// Adds its lifetime to time, spent in ICU
+class [[maybe_unused]] icu_timer
+{
+public:
+#if defined(UNICODE_METRICS)
+	icu_timer() noexcept : start(std::chrono::steady_clock::now()) {}
+	~icu_timer()
+	{
+		auto elapsed = std::chrono::steady_clock::now() - start;
+		add(
+			counter::icu_nanoseconds, 
+			std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()
+		);
+	}
+#else
+	icu_timer() noexcept = default;
+#endif
+
+	icu_timer(const icu_timer &) = delete;
+	icu_timer &operator=(const icu_timer &) = delete;
+
+#if defined(UNICODE_METRICS)
+private:
+	/// Time of creation
+	std::chrono::steady_clock::time_point start;
+#endif
+};
+
+} // namespace unicode::metrics
@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <ranges>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "unicode/collator.hpp"
+
+namespace unicode
+{
+
+/// Non-owning view over collation sort key
+class sort_key_view
+{
+public:
+	/// View over empty key
+	sort_key_view() = default;
+	/// View over key bytes
+	explicit sort_key_view(std::span<const uint8_t> bytes) noexcept
+		: key(bytes) {}
+
+	/// Get bytes of key without terminating zero
+	std::span<const uint8_t> bytes() const noexcept { return key; }
+
+	/// Get size of key in bytes
+	size_t size() const noexcept { return key.size(); }
+
+	/// Is key empty?
+	[[nodiscard]]
+	bool empty() const noexcept { return key.empty(); }
+
+	/// Keys are equal, if their strings are equal for collator
+	bool operator==(const sort_key_view &other) const noexcept
+	{
+		return (*this <=> other) == 0;
+	}
+
+	/// Keys are ordered as their strings, compared with collator
+	std::strong_ordering operator<=>(
+		const sort_key_view &other
+	) const noexcept
+	{
+		auto common = std::min(key.size(), other.key.size());
+		if (common != 0)
+		{
+			if (auto res = std::memcmp(key.data(), other.key.data(), common))
+			{
+				return res <=> 0;
+			}
+		}
+		return key.size() <=> other.key.size();
+	}
+
+private:
+	/// Bytes of key
+	std::span<const uint8_t> key;
+};
+
+/// Collation sort key of a string.
+/// Comparing keys with memcmp is equivalent to comparing their strings
+class sort_key
+{
+public:
+	/// Empty key
+	sort_key() = default;
+	/// Get sort key of UTF-8 string
+	explicit sort_key(
+		std::string_view string,
+		const collator &coll = collator::cached()
+	) noexcept;
+
+	sort_key(const sort_key &other)
+		: sort_key(other.view()) {}
+	sort_key(sort_key &&) noexcept = default;
+	sort_key &operator=(const sort_key &other)
+	{
+		return *this = sort_key(other.view());
+	}
+	sort_key &operator=(sort_key &&) noexcept = default;
+
+	/// Copy key from view
+	explicit sort_key(sort_key_view view)
+		: buffer(new uint8_t[view.size()]), length(view.size())
+	{
+		std::ranges::copy(view.bytes(), buffer.get());
+	}
+
+	/// Get non-owning view over key
+	sort_key_view view() const noexcept
+	{
+		return sort_key_view(bytes());
+	}
+	operator sort_key_view() const noexcept { return view(); }
+
+	/// Get bytes of key without terminating zero
+	std::span<const uint8_t> bytes() const noexcept
+	{
+		return {buffer.get(), length};
+	}
+
+	/// Get size of key in bytes
+	size_t size() const noexcept { return length; }
+
+	/// Is key empty?
+	[[nodiscard]]
+	bool empty() const noexcept { return length == 0; }
+
+	bool operator==(const sort_key &other) const noexcept
+	{
+		return view() == other.view();
+	}
+	std::strong_ordering operator<=>(const sort_key &other) const noexcept
+	{
+		return view() <=> other.view();
+	}
+
+private:
+	/// Bytes of key
+	std::unique_ptr<uint8_t[]> buffer;
+	/// Size of key in bytes
+	size_t length = 0;
+};
+
+/// Sort keys of many strings, stored in one contiguous arena
+class sort_keys
+{
+public:
+	/// Add sort key of UTF-8 string to the end of arena
+	void push_back(std::string_view string, const collator &coll) noexcept;
+
+	/// Reserve memory for keys
+	void reserve(size_t keys, size_t bytes)
+	{
+		ends.reserve(keys);
+		arena.reserve(bytes);
+	}
+
+	/// Get key by index
+	sort_key_view operator[](size_t index) const noexcept
+	{
+		assert(index < size() && "out of range");
+
+		size_t begin = index == 0 ? 0 : ends[index - 1];
+		return sort_key_view(
+			std::span<const uint8_t>(arena).subspan(begin, ends[index] - begin)
+		);
+	}
+
+	/// Get number of keys
+	size_t size() const noexcept { return ends.size(); }
+
+	/// Is there no keys?
+	[[nodiscard]]
+	bool empty() const noexcept { return ends.empty(); }
+
+	/// Get bytes of all keys
+	std::span<const uint8_t> bytes() const noexcept { return arena; }
+
+private:
+	/// Bytes of all keys, one after another
+	std::vector<uint8_t> arena;
+	/// Offsets of ends of keys inside arena
+	std::vector<size_t> ends;
+};
+
+/// Get sort keys of all strings in one contiguous arena
+template<std::ranges::sized_range Strings>
+requires std::convertible_to<
+	std::ranges::range_reference_t<const Strings>,
+	std::string_view
+>
+sort_keys make_sort_keys(
+	const Strings &strings,
+	const collator &coll = collator::cached()
+) noexcept
+{
+	sort_keys keys;
+	keys.reserve(std::ranges::size(strings), 0);
+	for (auto &&string : strings)
+	{
+		keys.push_back(std::string_view(string), coll);
+	}
+	return keys;
+}
+
+namespace execution
+{
+
+/// Policy to run algorithm on current thread
+struct sequenced_policy {};
+/// Policy to run algorithm on all hardware threads
+struct parallel_policy {};
+
+/// Run algorithm on current thread
+inline constexpr sequenced_policy seq{};
+/// Run algorithm on all hardware threads
+inline constexpr parallel_policy par{};
+
+/// Is type an execution policy?
+template<typename T>
+concept policy = 
+	std::same_as<std::remove_cvref_t<T>, sequenced_policy> ||
+	std::same_as<std::remove_cvref_t<T>, parallel_policy>;
+
+} // namespace execution
+
+/// Get indices of strings in order of their sort keys.
+/// Keys are built once per distinct string, 
+/// so collator isn't called on comparison.
+/// Parallel ordering splits strings into chunks, that are keyed 
+/// and sorted on their own threads, and merges them
+std::vector<size_t> collation_order(
+	std::span<const std::string_view> strings,
+	std::string_view locale = {},
+	collation_strength strength = collation_strength::tertiary,
+	bool parallel = false
+) noexcept;
+
+/// Sort strings with rules of locale, faster than std::sort for big ranges.
+/// Empty locale means default locale, like for operator<=>.
+/// Policy execution::seq sorts on current thread, execution::par 
+/// uses all hardware threads.
+/// @note Policies are own tags, because standard ones 
+/// require TBB with libstdc++
+template<
+	std::ranges::random_access_range Strings, 
+	execution::policy ExecutionPolicy
+>
+requires std::convertible_to<
+	std::ranges::range_reference_t<Strings>,
+	std::string_view
+>
+void sort(
+	Strings &&strings, 
+	std::string_view locale,
+	ExecutionPolicy &&,
+	collation_strength strength = collation_strength::tertiary
+)
+{
+	std::vector<std::string_view> bytes;
+	bytes.reserve(std::ranges::size(strings));
+	for (auto &&string : strings) { bytes.emplace_back(string); }
+
+	constexpr bool parallel = std::same_as<
+		std::remove_cvref_t<ExecutionPolicy>, 
+		execution::parallel_policy
+	>;
+	auto order = collation_order(bytes, locale, strength, parallel);
+
+	std::vector<std::ranges::range_value_t<Strings>> sorted;
+	sorted.reserve(order.size());
+	auto first = std::ranges::begin(strings);
+	for (auto index : order) { sorted.push_back(std::move(first[index])); }
+	std::ranges::move(sorted, first);
+}
+
+/// Sort strings with rules of locale on current thread
+template<std::ranges::random_access_range Strings>
+requires std::convertible_to<
+	std::ranges::range_reference_t<Strings>,
+	std::string_view
+>
+void sort(Strings &&strings, std::string_view locale = {})
+{
+	unicode::sort(strings, locale, execution::seq);
+}
+
+} // namespace unicode
+
+template<>
+struct std::hash<unicode::sort_key_view>
+{
+	size_t operator()(const unicode::sort_key_view &key) const noexcept
+	{
+		auto bytes = key.bytes();
+		return std::hash<std::string_view>{}(
+			std::string_view(
+				reinterpret_cast<const char *>(bytes.data()), bytes.size()
+			)
+		);
+	}
+};
+
+template<>
+struct std::hash<unicode::sort_key>
+{
+	size_t operator()(const unicode::sort_key &key) const noexcept
+	{
+		return std::hash<unicode::sort_key_view>{}(key.view());
+	}
+};
@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cassert>
+#include <string>
+#include <string_view>
+#include <utility>
+
+#include "unicode/comparable_interface.hpp"
+#include "unicode/string_view.hpp"
+
+namespace unicode
+{
+
+/// Owning string of unicode characters, which layout is kept in sync 
+/// with its bytes.
+///
+/// Short strings are stored inline together with their layout,
+/// so they don't allocate memory at all.
+/// Modifications split only characters around the change again
+class string : public comparable_interface<string>
+{
+public:
+	using value_type = character_view;
+	using size_type = string_view::size_type;
+	using difference_type = string_view::difference_type;
+	using iterator = string_view::iterator;
+	using const_iterator = string_view::const_iterator;
+	using reverse_iterator = string_view::reverse_iterator;
+	using const_reverse_iterator = string_view::const_reverse_iterator;
+
+	/// Empty string
+	string() = default;
+	/// Copy bytes of string
+	string(const char *bytes) : string(std::string(bytes)) {}
+	/// Copy bytes of string
+	string(std::string_view bytes) : string(std::string(bytes)) {}
+	/// Take bytes of string
+	string(std::string &&bytes) 
+		: storage(std::move(bytes)), characters(storage) {}
+
+	string(const string &other)
+		: storage(other.storage), characters(other.characters)
+	{
+		characters.bytes = storage;
+	}
+	string(string &&other) noexcept
+		: storage(std::move(other.storage)), 
+		characters(std::move(other.characters))
+	{
+		characters.bytes = storage;
+		other.clear();
+	}
+	string &operator=(const string &other)
+	{
+		if (this != &other) { *this = string(other); }
+		return *this;
+	}
+	string &operator=(string &&other) noexcept
+	{
+		if (this == &other) { return *this; }
+
+		storage = std::move(other.storage);
+		characters = std::move(other.characters);
+		characters.bytes = storage;
+		other.clear();
+		return *this;
+	}
+
+	/// Get view over characters
+	const string_view &view() const noexcept { return characters; }
+	operator const string_view &() const noexcept { return characters; }
+
+	/// Get underlying bytes
+	operator std::string_view() const noexcept { return storage; }
+
+	/// Get underlying bytes
+	const std::string &str() const noexcept { return storage; }
+
+	/// Get iterator for first character
+	iterator begin() const noexcept { return characters.begin(); }
+	/// Get iterator for one past last character
+	iterator end() const noexcept { return characters.end(); }
+	/// Get reverse iterator for last character
+	reverse_iterator rbegin() const noexcept { return characters.rbegin(); }
+	/// Get reverse iterator for one before first character
+	reverse_iterator rend() const noexcept { return characters.rend(); }
+
+	/// Get first character
+	character_view front() const noexcept { return characters.front(); }
+	/// Get last character
+	character_view back() const noexcept { return characters.back(); }
+
+	/// Get size of string in characters
+	size_t size() const noexcept { return characters.size(); }
+
+	/// Is string empty?
+	[[nodiscard]]
+	bool empty() const noexcept { return storage.empty(); }
+
+	/// Get character by index
+	template<std::integral index_t>
+	character_view operator[](index_t index) const noexcept
+	{
+		return characters[index];
+	}
+
+	/// Append bytes to the end of string
+	string &append(std::string_view bytes)
+	{
+		return replace_bytes({.offset = storage.size()}, bytes);
+	}
+	string &operator+=(std::string_view bytes) { return append(bytes); }
+
+	/// Insert bytes before character
+	string &insert(size_t index, std::string_view bytes)
+	{
+		return replace_bytes({.offset = byte_offset(index)}, bytes);
+	}
+
+	/// Erase characters, starting from index
+	string &erase(size_t index, size_t count = 1)
+	{
+		assert(index <= size() && "out of range");
+
+		auto begin = byte_offset(index);
+		auto end = byte_offset(std::min(index + count, size()));
+		return replace_bytes({.offset = begin, .size = end - begin}, {});
+	}
+
+	/// Replace characters, starting from index, with bytes
+	string &replace(size_t index, size_t count, std::string_view bytes)
+	{
+		assert(index <= size() && "out of range");
+
+		auto begin = byte_offset(index);
+		auto end = byte_offset(std::min(index + count, size()));
+		return replace_bytes({.offset = begin, .size = end - begin}, bytes);
+	}
+
+	/// Remove all characters
+	void clear() noexcept
+	{
+		storage.clear();
+		characters = string_view();
+	}
+
+	/// Release unused memory
+	void shrink_to_fit()
+	{
+		storage.shrink_to_fit();
+		characters.bytes = storage;
+		characters.layout.shrink_to_fit();
+	}
+
+private:
+	/// Bytes of string
+	std::string storage;
+	/// View over bytes
+	string_view characters;
+
+	/// Get offset of the first byte of character
+	size_t byte_offset(size_t index) const noexcept
+	{
+		if (index == size()) { return storage.size(); }
+		return characters[index].data() - storage.data();
+	}
+
+	/// Replace range of bytes and update layout
+	string &replace_bytes(byte_range range, std::string_view bytes)
+	{
+		storage.replace(range.offset, range.size, bytes);
+		characters.update(storage, range, bytes.size());
+		return *this;
+	}
+};
+
+} // namespace unicode
@@ -1,16 +1,32 @@
 #pragma once
 
+#include <algorithm>
+#include <concepts>
+#include <cstring>
+#include <cstdint>
+#include <span>
 #include <string>
 #include <string_view>
+#include <utility>
 #include <vector>
 
 #include "unicode/layout.hpp"
+#include "unicode/layout_cache.hpp"
 #include "unicode/comparable_interface.hpp"
 #include "unicode/character_view.hpp"
+#include "unicode/utf8/grapheme.hpp"
 
 namespace unicode
 {
 
+/// Tag for views, that split string into characters on demand
+struct lazy_t { explicit lazy_t() = default; };
+/// Tag for views, that split string into characters on demand
+inline constexpr lazy_t lazy{};
+
+class string_slice;
+struct checked_string_view;
+
 /// View over unicode characters
 class string_view : public comparable_interface<string_view>
 {
@@ -19,7 +35,11 @@ public:
 	using size_type = std::string_view::size_type;
 	using difference_type = std::string_view::difference_type;
 
-	/// Iterator over unicode characters
+	/// Size, that means all characters until the end of string
+	static constexpr size_type npos = std::string_view::npos;
+
+	/// Iterator over unicode characters.
+	/// Remembers its block, so sequential steps don't search the layout
 	class iterator
 	{
 	private:
@@ -37,27 +57,54 @@ public:
 
 		/// Create iterator over unicode characters for string view
 		iterator(const string_view &view, size_t index = 0) noexcept
-			: view(&view), index(index)
-		{}
+			: view(&view)
+		{
+			// Begin and end iterators, that loops may create on each check,
+			// are inside of the first and the last blocks
+			auto &layout = view.layout;
+			if (
+				view.complete() && !layout.empty() &&
+				(index == 0 || index >= layout.offset(layout.size() - 1))
+			)
+			{
+				this->index = index;
+				enter_block(index == 0 ? 0 : layout.size() - 1);
+				byte_offset = 
+					layout[block_index].byte_offset + 
+					(index - block_begin) * character_size;
+				return;
+			}
+			seek(index);
+		}
 
 		/// Random access iterator methods
 		iterator &operator+=(difference_type offset) noexcept
 		{
-			index += offset;
+			size_t target = index + offset;
+			// Stay inside of current block without search
+			if (block_begin <= target && target < block_end)
+			{
+				byte_offset += offset * character_size;
+				index = target;
+				return *this;
+			}
+
+			seek(target);
 			return *this;
 		}
 		iterator &operator-=(difference_type offset) noexcept
 		{
-			index -= offset;
-			return *this;
+			return *this += -offset;
 		}
 		iterator operator+(difference_type offset) const noexcept
 		{
-			return iterator(*view, index + offset);
+			auto it = *this;
+			return it += offset;
 		}
 		iterator operator-(difference_type offset) const noexcept
 		{
-			return iterator(*view, index - offset);
+			auto it = *this;
+			return it -= offset;
 		}
 		difference_type operator-(const iterator &other) const noexcept
 		{
@@ -69,29 +116,58 @@ public:
 		}
 		iterator &operator++() noexcept
 		{
+			assert(index < view->scanned.characters && "incrementing end iterator");
+
 			++index;
+			byte_offset += character_size;
+			if (index == block_end) 
+			{
+				if (block_index + 1 < view->layout.size())
+				{
+					enter_block(block_index + 1);
+				}
+				else
+				{
+					// Lazy view has more characters after its layout
+					seek(index);
+				}
+			}
 			return *this;
 		}
 		iterator operator++(int) noexcept
 		{
-			return iterator(*view, index++);
+			auto it = *this;
+			++*this;
+			return it;
 		}
 		iterator &operator--() noexcept
 		{
+			assert(index > 0 && "decrementing begin iterator");
+
+			if (index == block_begin) { enter_block(block_index - 1); }
 			--index;
+			byte_offset -= character_size;
 			return *this;
 		}
 		iterator operator--(int) noexcept
 		{
-			return iterator(*view, index--);
+			auto it = *this;
+			--*this;
+			return it;
 		}
 		value_type operator*() const noexcept
 		{
-			return view->operator[](index);
+			assert(index < view->scanned.characters && "dereferencing end iterator");
+
+			return character_view(
+				std::string_view(
+					view->bytes.data() + byte_offset, character_size
+				)
+			);
 		}
 		value_type operator[](difference_type offset) const noexcept
 		{
-			return view->operator[](index + offset);
+			return *(*this + offset);
 		}
 		bool operator==(const iterator &other) const noexcept
 		{
@@ -109,6 +185,60 @@ public:
 			);
 			return index <=> other.index;
 		}
+
+	private:
+		/// View takes byte offsets of iterators for slices
+		friend class string_view;
+
+		/// Index of block of current character
+		size_t block_index = 0;
+		/// Index of the first character of current block
+		size_t block_begin = 0;
+		/// Index of the first character after current block
+		size_t block_end = 0;
+		/// Size of characters inside of current block
+		size_t character_size = 0;
+		/// Offset of the first byte of current character
+		size_t byte_offset = 0;
+
+		/// Remember bounds of block, keeping index and byte offset
+		void enter_block(size_t new_block_index) noexcept
+		{
+			auto &layout = view->layout;
+
+			block_index = new_block_index;
+			block_begin = layout.offset(block_index);
+			block_end = end_of_block(block_index);
+			character_size = layout.character_size(block_index);
+		}
+
+		/// Get index of the first character after block
+		size_t end_of_block(size_t index) const noexcept
+		{
+			auto &layout = view->layout;
+			if (index + 1 < layout.size()) { return layout.offset(index + 1); }
+			// Last block never ends, so iterator past it has a valid offset.
+			// Last block of lazy view ends, where layout ends
+			return view->complete() ? SIZE_MAX : view->scanned.characters;
+		}
+
+		/// Move iterator to character, searching for its block
+		void seek(size_t target) noexcept
+		{
+			index = target;
+			view->scan(target);
+
+			auto &layout = view->layout;
+			if (layout.empty()) { return; }
+
+			auto [index, offset, block] = layout.block_for_character(target);
+			block_index = index;
+			block_begin = offset;
+			block_end = end_of_block(block_index);
+			character_size = block.character_size;
+			byte_offset = 
+				block.byte_offset + (target - block_begin) * character_size;
+		}
 	};
 
 	using const_iterator = iterator;
@@ -127,11 +257,62 @@ public:
 		: string_view(std::string_view(bytes)) {}
 	/// View over string
 	string_view(std::string_view bytes) 
-		: bytes(bytes), layout(layout::of(bytes)) {}
+		: bytes(bytes), layout(bytes.size()) 
+	{
+		metrics::add(metrics::counter::views);
+		scan_all();
+		layout.shrink_to_fit();
+	}
+	/// View over string, that splits it into characters on demand.
+	/// Layout is built up to the last accessed character.
+	/// Accessors, like operator[], find() or starts_with(), stay noexcept,
+	/// so failure to allocate memory for layout terminates program
+	/// @warning Accessing characters modifies view, 
+	/// so it can't be shared between threads without synchronization
+	string_view(
+		std::string_view bytes, 
+		lazy_t,
+		std::pmr::memory_resource *resource = 
+			std::pmr::get_default_resource()
+	) noexcept
+		: bytes(bytes), layout(bytes.size(), resource) 
+	{
+		metrics::add(metrics::counter::views);
+	}
+	/// View over string with layout, allocated from resource
+	string_view(
+		std::string_view bytes, 
+		std::pmr::memory_resource *resource
+	) 
+		: bytes(bytes), layout(bytes.size(), resource)
+	{
+		metrics::add(metrics::counter::views);
+		scan_all();
+		layout.shrink_to_fit();
+	}
+	/// View over string with already built layout
+	/// @warning Layout must be built for the same string
+	string_view(std::string_view bytes, unicode::layout layout) noexcept
+		: bytes(bytes), layout(std::move(layout))
+	{
+		metrics::add(metrics::counter::views);
+		mark_complete();
+	}
+	/// View over string with layout, taken from cache.
+	/// Layout of cached string is copied without splitting it again,
+	/// while strings, that cache doesn't accept, are split as usual
+	string_view(std::string_view bytes, layout_cache &cache) noexcept
+		: string_view(bytes, cache.of(bytes)) {}
 	/// View over string
 	string_view(const std::string &bytes)
 		: string_view(std::string_view(bytes)) {}
 
+	/// Create view over string, if it's well-formed UTF-8.
+	/// Bytes are validated in the same pass, that splits them 
+	/// into characters, instead of a separate pass before it.
+	/// Other constructors let ICU replace ill-formed sequences
+	static checked_string_view from_checked(std::string_view bytes) noexcept;
+
 	/// Get iterator for first character
 	iterator begin() const noexcept
 	{
@@ -186,43 +367,179 @@ public:
 	}
 
 	/// Get size of string in characters
-	constexpr size_t size() const noexcept 
+	size_t size() const noexcept 
 	{
-		if (layout.offsets.empty()) { return 0; }
-
-		auto &last_block = layout.blocks.back();
-		return 
-			layout.offsets.back() + 
-				(bytes.size() - last_block.byte_offset) / 
-				last_block.character_size; 
+		scan_all();
+		return scanned.characters;
 	}
 
 	/// Is string empty?
 	[[nodiscard]]
-	bool empty() const noexcept { return size() == 0; }
+	bool empty() const noexcept { return bytes.empty(); }
+
+	/// Get index of character, that contains byte.
+	/// Offset at the end of string gives size().
+	/// Block is found by binary search over byte offsets of blocks
+	size_type index_of_byte(size_t byte_offset) const noexcept
+	{
+		assert(byte_offset <= bytes.size() && "byte out of range");
+		scan_bytes(byte_offset + 1);
+		if (byte_offset >= bytes.size()) { return scanned.characters; }
+
+		auto [index, offset, block] = layout.block_for_byte(byte_offset);
+		return offset + (byte_offset - block.byte_offset) / block.character_size;
+	}
+
+	/// Get offset of the first byte of character.
+	/// Index size() gives size of string in bytes
+	size_t byte_of_index(size_type index) const noexcept
+	{
+		scan(index);
+		assert(index <= scanned.characters && "index out of range");
+		return byte_of(index);
+	}
+
+	/// Get layout of string, building it for the whole string
+	const unicode::layout &blocks() const noexcept
+	{
+		scan_all();
+		return layout;
+	}
+
+	/// Call function with every run of consecutive characters 
+	/// with same size, so characters of run can be handled in one loop
+	/// without searching for their blocks
+	template<std::invocable<const character_run &> Function>
+	void for_each_block(Function &&function) const
+	{
+		for_each_run(0, [&](const character_run &run)
+		{
+			function(run);
+			return true;
+		});
+	}
+
+	/// Call function with every run of consecutive characters 
+	/// with same size as fixed_width_span<W>. Runs of characters, 
+	/// that are single code points of 1-4 bytes, have W equal to their size,
+	/// so function is instantiated for each of these widths.
+	/// Other runs, like "e\u0301" or "\r\n", have W = dynamic_width
+	template<typename Function>
+		requires
+			std::invocable<Function &, fixed_width_span<1>> &&
+			std::invocable<Function &, fixed_width_span<2>> &&
+			std::invocable<Function &, fixed_width_span<3>> &&
+			std::invocable<Function &, fixed_width_span<4>> &&
+			std::invocable<Function &, fixed_width_span<dynamic_width>>
+	void visit_blocks(Function &&function) const
+	{
+		for_each_run(0, [&](const character_run &run)
+		{
+			switch (run.character_size)
+			{
+			// Characters of one byte are always single code points
+			case 1: function(fixed_width_span<1>{run.bytes}); break;
+			case 2: visit_width<2>(run.bytes, function); break;
+			case 3: visit_width<3>(run.bytes, function); break;
+			case 4: visit_width<4>(run.bytes, function); break;
+			default: function(fixed_width_span<dynamic_width>{run}); break;
+			}
+			return true;
+		});
+	}
+
+	/// Write offsets of the first bytes of characters, starting from
+	/// character with index first, while they fit into output.
+	/// @return Number of written offsets
+	/// @warning String must be smaller than 4 GB
+	size_t copy_boundaries(
+		std::span<uint32_t> output,
+		size_t first = 0
+	) const noexcept
+	{
+		assert(bytes.size() <= UINT32_MAX && "offsets don't fit into output");
+
+		size_t written = 0;
+		for_each_run(first, [&](const character_run &run)
+		{
+			auto begin = static_cast<uint32_t>(run.bytes.data() - bytes.data());
+			auto size = static_cast<uint32_t>(run.character_size);
+			auto count = std::min(run.size(), output.size() - written);
+			auto *offsets = output.data() + written;
+			for (size_t i = 0; i < count; ++i)
+			{
+				offsets[i] = begin + static_cast<uint32_t>(i) * size;
+			}
+			written += count;
+			return written < output.size();
+		});
+		return written;
+	}
+
+	/// Is layout built for the whole string?
+	bool complete() const noexcept { return scanned.bytes == bytes.size(); }
 
 	/// Get underlying bytes
 	constexpr operator std::string_view() const noexcept { return bytes; }
 
 	/// Update layout after change in string
-	void update() { layout = layout::of(bytes); }
+	void update() 
+	{ 
+		layout = unicode::layout(bytes.size(), layout.memory_resource());
+		scanned = {};
+		scan_all();
+		layout.shrink_to_fit();
+	}
+
+	/// Update layout after bytes of range were replaced with new_length bytes.
+	/// Only characters around the change are split again. 
+	/// View keeps pointing to the same data
+	void update(byte_range changed, size_t new_length) noexcept
+	{
+		update(
+			std::string_view(
+				bytes.data(), bytes.size() - changed.size + new_length
+			),
+			changed,
+			new_length
+		);
+	}
+
+	/// Update layout after bytes of range were replaced with new_length bytes
+	/// and string was moved to new location
+	void update(
+		std::string_view new_bytes,
+		byte_range changed,
+		size_t new_length
+	) noexcept
+	{
+		assert(
+			new_bytes.size() + changed.size == bytes.size() + new_length &&
+			"size of string doesn't match the change"
+		);
+
+		bytes = new_bytes;
+		layout_builder::current().update(
+			layout, scanned, bytes, changed, new_length
+		);
+	}
 
 	/// Swap 2 views
 	void swap(string_view other)
 	{
 		std::swap(bytes, other.bytes);
 		std::swap(layout, other.layout);
+		std::swap(scanned, other.scanned);
 	}
 
 	/// Get character by absolute index
 	character_view operator[](size_type index) const noexcept
 	{
-		assert(index < size() && "out of range");
+		if (index >= scanned.characters) { scan(index); }
+		assert(index < scanned.characters && "out of range");
 
-		auto block_index = layout.block_index_for_character(index);
-
-		auto offset = layout.offsets[block_index];
-		auto &block = layout.blocks[block_index];
+		auto [block_index, offset, block] = 
+			layout.block_for_character(index);
 
 		return character_view(
 			bytes.substr(
@@ -231,21 +548,478 @@ public:
 		);
 	}
 
+	/// Find the first occurrence of characters, starting from character pos.
+	/// Matches, that split characters, like "e" inside of "e\u0301", 
+	/// are skipped
+	/// @note Lazy view is split up to the end
+	/// @return Index of the first character of match or npos
+	size_type find(
+		std::string_view characters, 
+		size_type pos = 0
+	) const noexcept
+	{
+		scan_all();
+		if (pos > scanned.characters) { return npos; }
+
+		auto start = byte_of(pos);
+		for (
+			auto match = find_bytes(characters, start); 
+			match != npos; 
+			match = find_bytes(characters, match + 1)
+		)
+		{
+			auto index = character_at(match);
+			if (index != npos && is_boundary(match + characters.size()))
+			{
+				return index;
+			}
+		}
+		return npos;
+	}
+
+	/// Find the last occurrence of characters, that starts 
+	/// at or before character pos. Matches, that split characters,
+	/// are skipped
+	/// @note Lazy view is split up to the end
+	/// @return Index of the first character of match or npos
+	size_type rfind(
+		std::string_view characters, 
+		size_type pos = npos
+	) const noexcept
+	{
+		scan_all();
+		auto start = byte_of(std::min(pos, scanned.characters));
+		for (
+			auto match = bytes.rfind(characters, start); 
+			match != npos; 
+			match = match == 0 ? npos : bytes.rfind(characters, match - 1)
+		)
+		{
+			auto index = character_at(match);
+			if (index != npos && is_boundary(match + characters.size()))
+			{
+				return index;
+			}
+		}
+		return npos;
+	}
+
+	/// Does string contain characters?
+	bool contains(std::string_view characters) const noexcept
+	{
+		return find(characters) != npos;
+	}
+
+	/// Does string start with characters?
+	/// @note Lazy view is split only up to the end of characters
+	bool starts_with(std::string_view characters) const noexcept
+	{
+		if (!bytes.starts_with(characters)) { return false; }
+		scan_bytes(characters.size() + 1);
+		return is_boundary(characters.size());
+	}
+
+	/// Does string end with characters?
+	/// @note Lazy view is split up to the start of characters,
+	/// because boundaries depend on preceding text
+	bool ends_with(std::string_view characters) const noexcept
+	{
+		if (!bytes.ends_with(characters)) { return false; }
+		auto start = bytes.size() - characters.size();
+		scan_bytes(start + 1);
+		return is_boundary(start);
+	}
+
+	/// Get view over count characters, starting from pos.
+	/// Slice uses layout of this view, so it's created without 
+	/// splitting characters again
+	/// @warning View must outlive its slices
+	string_slice substr(
+		size_type pos = 0, 
+		size_type count = npos
+	) const noexcept;
+
+	/// Get view over characters between iterators of this view
+	/// @warning View must outlive its slices
+	string_slice slice(iterator first, iterator last) const noexcept;
+
 	/// Get character by index. Negative indexes are relative to end of string
 	template<std::signed_integral index_t>
 	character_view operator[](index_t index) const noexcept
 	{
 		if (index < 0) { index += size(); }
-		assert(0 <= index && size_type(index) < size() && "out of range");
+		assert(0 <= index && "out of range");
 
 		return operator[](static_cast<size_type>(index));
 	}
 
 private:
+	/// Owning string moves its bytes together with view
+	friend class string;
+
 	/// Bytes of string
 	std::string_view bytes;
-	/// Layout of string
-	layout layout;
+	/// Layout of string. Lazy view builds it on demand
+	mutable unicode::layout layout;
+	/// Part of string, covered by layout
+	mutable layout_progress scanned;
+
+	/// Build layout, until it has character with specified index
+	void scan(size_t index) const noexcept
+	{
+		while (index >= scanned.characters && !complete())
+		{
+			// Scanned part at least doubles, so lazy iteration stays linear
+			auto byte_count = std::max({
+				2 * scanned.bytes, 
+				scanned.bytes + (index - scanned.characters) + 1,
+				size_t(64)
+			});
+			layout_builder::current().extend(
+				layout, bytes, scanned, byte_count
+			);
+		}
+	}
+
+	/// Build layout, until it covers specified number of bytes
+	void scan_bytes(size_t byte_count) const noexcept
+	{
+		if (scanned.bytes >= byte_count || complete()) { return; }
+		layout_builder::current().extend(
+			layout, bytes, scanned, std::max(2 * scanned.bytes, byte_count)
+		);
+	}
+
+	/// Find bytes of string, starting from byte offset
+	size_type find_bytes(
+		std::string_view needle, 
+		size_t byte_offset
+	) const noexcept
+	{
+		if (byte_offset > bytes.size()) { return npos; }
+#if defined(__GLIBC__)
+		// Vectorized search of glibc
+		if (needle.empty()) { return byte_offset; }
+		auto *match = static_cast<const char *>(memmem(
+			bytes.data() + byte_offset, bytes.size() - byte_offset,
+			needle.data(), needle.size()
+		));
+		return match ? size_type(match - bytes.data()) : npos;
+#else
+		return bytes.find(needle, byte_offset);
+#endif
+	}
+
+	/// Get offset of the first byte of character. 
+	/// Character after the last one starts at the end of string
+	/// @warning Layout must be built for the whole string
+	size_t byte_of(size_t character_index) const noexcept
+	{
+		if (character_index >= scanned.characters) { return bytes.size(); }
+
+		auto [index, offset, block] = 
+			layout.block_for_character(character_index);
+		return 
+			block.byte_offset + (character_index - offset) * block.character_size;
+	}
+
+	/// Get index of character, that starts at byte offset,
+	/// or npos, if byte is inside of character
+	/// @warning Layout must cover the byte, or the whole string
+	size_type character_at(size_t byte_offset) const noexcept
+	{
+		if (byte_offset >= bytes.size()) 
+		{ 
+			return byte_offset == bytes.size() ? scanned.characters : npos; 
+		}
+
+		auto [index, offset, block] = layout.block_for_byte(byte_offset);
+		auto inside = byte_offset - block.byte_offset;
+		if (inside % block.character_size != 0) { return npos; }
+		return offset + inside / block.character_size;
+	}
+
+	/// Is there boundary of characters before byte?
+	/// @warning Layout must cover the byte, or the whole string
+	bool is_boundary(size_t byte_offset) const noexcept
+	{
+		return character_at(byte_offset) != npos;
+	}
+
+	/// Call function with parts of run of characters of Width bytes,
+	/// split where characters change from single code points to clusters
+	/// of several code points, like "e\u0301", or back
+	template<size_t Width, typename Function>
+	static void visit_width(std::string_view run, Function &function)
+	{
+		// Character is one code point, if its lead byte starts 
+		// sequence of the whole character
+		auto single = [&](size_t offset)
+		{
+			return utf8::sequence_size(run[offset]) == Width;
+		};
+
+		// Runs of clusters are rare, so the whole run is checked first.
+		// The only cluster of two bytes is CR LF, which is found by memchr
+		bool all_single = true;
+		if constexpr (Width == 2)
+		{
+			all_single = run.find('\r') == std::string_view::npos;
+		}
+		else
+		{
+			for (size_t offset = 0; offset < run.size(); offset += Width)
+			{
+				all_single &= single(offset);
+			}
+		}
+		if (all_single) 
+		{ 
+			function(fixed_width_span<Width>{run}); 
+			return;
+		}
+
+		for (size_t begin = 0; begin < run.size();)
+		{
+			auto is_single = single(begin);
+			auto end = begin + Width;
+			while (end < run.size() && single(end) == is_single) 
+			{ 
+				end += Width; 
+			}
+
+			auto part = run.substr(begin, end - begin);
+			if (is_single) 
+			{ 
+				function(fixed_width_span<Width>{part}); 
+			}
+			else
+			{
+				function(fixed_width_span<dynamic_width>{{
+					.bytes = part, 
+					.character_size = Width
+				}});
+			}
+			begin = end;
+		}
+	}
+
+	/// Call function with runs of characters with same size, 
+	/// starting from character with index first, until it returns false
+	template<typename Function>
+	void for_each_run(size_t first, Function &&function) const
+	{
+		scan_all();
+		if (first >= scanned.characters) { return; }
+
+		auto [index, offset, block] = layout.block_for_character(first);
+		auto character = first;
+		auto character_size = block.character_size;
+		auto byte_offset = 
+			block.byte_offset + (first - offset) * character_size;
+		for (auto next = layout.next_run(index);; next = layout.next_run(next))
+		{
+			auto end = 
+				next < layout.size() ? layout.offset(next) : scanned.characters;
+			auto size = (end - character) * character_size;
+			if (
+				!function(character_run{
+					.bytes = bytes.substr(byte_offset, size),
+					.character_size = character_size
+				}) || 
+				next == layout.size()
+			)
+			{
+				return;
+			}
+
+			character = end;
+			character_size = layout.character_size(next);
+			byte_offset += size;
+		}
+	}
+
+	/// Mark layout, that covers the whole string, as scanned
+	void mark_complete() noexcept
+	{
+		scanned.bytes = bytes.size();
+		if (layout.empty()) { return; }
+
+		auto last_block = layout.back();
+		assert(
+			last_block.byte_offset < bytes.size() && 
+			"layout doesn't match the string"
+		);
+		scanned.characters = 
+			layout.offset(layout.size() - 1) + 
+				(bytes.size() - last_block.byte_offset) / 
+				last_block.character_size;
+	}
+
+	/// Build layout for the whole string
+	void scan_all() const noexcept
+	{
+		if (complete()) { return; }
+		layout_builder::current().extend(layout, bytes, scanned, SIZE_MAX);
+	}
+};
+
+/// View over characters of part of string_view.
+/// Uses blocks of parent view with a window of characters over them,
+/// so creating and indexing of slices doesn't allocate memory.
+/// Iterators of slice are iterators of parent view
+class string_slice : public comparable_interface<string_slice>
+{
+public:
+	using value_type = character_view;
+	using size_type = string_view::size_type;
+	using difference_type = string_view::difference_type;
+	using iterator = string_view::iterator;
+	using const_iterator = string_view::const_iterator;
+	using reverse_iterator = string_view::reverse_iterator;
+	using const_reverse_iterator = string_view::const_reverse_iterator;
+
+	/// Get iterator for first character
+	iterator begin() const noexcept { return first; }
+	/// Get iterator for one past last character
+	iterator end() const noexcept { return last; }
+	/// Get reverse iterator for last character
+	reverse_iterator rbegin() const noexcept { return reverse_iterator(last); }
+	/// Get reverse iterator for one before first character
+	reverse_iterator rend() const noexcept { return reverse_iterator(first); }
+
+	/// Get first character
+	character_view front() const noexcept { return operator[](0); }
+	/// Get last character
+	character_view back() const noexcept { return operator[](size() - 1); }
+
+	/// Get size of slice in characters
+	size_t size() const noexcept { return last.index - first.index; }
+
+	/// Is slice empty?
+	[[nodiscard]]
+	bool empty() const noexcept { return first == last; }
+
+	/// Get character by index inside of slice
+	character_view operator[](size_type index) const noexcept
+	{
+		assert(index < size() && "out of range");
+		return first[index];
+	}
+
+	/// Get index of the first character inside of parent view
+	size_t offset() const noexcept { return first.index; }
+
+	/// Get underlying bytes
+	operator std::string_view() const noexcept { return bytes; }
+
+	/// Get view over count characters of slice, starting from pos
+	string_slice substr(
+		size_type pos = 0, 
+		size_type count = string_view::npos
+	) const noexcept
+	{
+		assert(pos <= size() && "out of range");
+		auto begin = first + pos;
+		auto end = count >= size() - pos ? last : begin + count;
+		return view->slice(begin, end);
+	}
+
+private:
+	/// Only views create slices
+	friend class string_view;
+
+	/// Parent view
+	const string_view *view;
+	/// Iterator for the first character
+	iterator first;
+	/// Iterator for one past last character
+	iterator last;
+	/// Bytes of characters
+	std::string_view bytes;
+
+	/// Slice of view between iterators with specified bytes
+	string_slice(
+		const string_view &view, 
+		iterator first, 
+		iterator last, 
+		std::string_view bytes
+	) noexcept
+		: view(&view), first(first), last(last), bytes(bytes) {}
 };
-	
+
+/// Get view over count characters, starting from pos
+inline string_slice string_view::substr(
+	size_type pos, 
+	size_type count
+) const noexcept
+{
+	// Lazy view splits characters only up to the end of slice
+	auto end = count >= npos - pos ? npos : pos + count;
+	if (end == npos) { scan_all(); } else { scan(end); }
+	end = std::min(end, scanned.characters);
+	assert(pos <= end && "out of range");
+
+	// End of short slice is usually inside of the same block
+	iterator first(*this, pos);
+	return slice(first, first + (end - pos));
+}
+
+/// Get view over characters between iterators of this view
+inline string_slice string_view::slice(
+	iterator first, 
+	iterator last
+) const noexcept
+{
+	assert(
+		first.view == this && last.view == this && 
+		"iterators from different view"
+	);
+	assert(first <= last && "wrong order of iterators");
+
+	// Iterator past the last character of view has valid byte offset
+	// only in non-empty views
+	auto begin = layout.empty() ? 0 : first.byte_offset;
+	auto end = layout.empty() ? 0 : last.byte_offset;
+	return string_slice(
+		*this, first, last, bytes.substr(begin, end - begin)
+	);
+}
+
+/// View over string, that may be ill-formed UTF-8
+struct checked_string_view
+{
+	/// View over string. Empty, if string is ill-formed
+	string_view view;
+	/// Offset of the first byte of ill-formed sequence, 
+	/// or npos for well-formed string
+	size_t error_offset = string_view::npos;
+
+	/// Is string well-formed?
+	explicit operator bool() const noexcept 
+	{
+		return error_offset == string_view::npos; 
+	}
+
+	/// Get view over well-formed string
+	const string_view &operator*() const noexcept
+	{
+		assert(*this && "string is ill-formed");
+		return view;
+	}
+	/// Access view over well-formed string
+	const string_view *operator->() const noexcept { return &**this; }
+};
+
+/// Create view over string, if it's well-formed UTF-8
+inline checked_string_view string_view::from_checked(
+	std::string_view bytes
+) noexcept
+{
+	unicode::layout layout;
+	auto error = layout_builder::current().build_checked(bytes, layout);
+	if (error != SIZE_MAX) { return {.view = {}, .error_offset = error}; }
+	return {.view = string_view(bytes, std::move(layout))};
+}
+
 } // namespace unicode
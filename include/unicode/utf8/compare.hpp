@@ -1,14 +1,45 @@
 #pragma once
 
+#include <compare>
 #include <string_view>
 
+namespace unicode
+{
+
+class collator;
+
+} // namespace unicode
+
 namespace unicode::utf8
 {
 
 /// Compare two UTF-8 strings with default locale comparison rules
+/// @note Uses collator, cached by current thread
 std::strong_ordering compare(
 	std::string_view lhs, 
 	std::string_view rhs
 ) noexcept;
 
+/// Compare two UTF-8 strings with rules of specific collator
+std::strong_ordering compare(
+	std::string_view lhs, 
+	std::string_view rhs,
+	const collator &coll
+) noexcept;
+
+/// Check that two UTF-8 strings are equal with default locale rules.
+/// Byte-identical strings are equal without collation
+/// @note Uses collator, cached by current thread
+bool equal(
+	std::string_view lhs, 
+	std::string_view rhs
+) noexcept;
+
+/// Check that two UTF-8 strings are equal with rules of specific collator
+bool equal(
+	std::string_view lhs, 
+	std::string_view rhs,
+	const collator &coll
+) noexcept;
+
 } // namespace unicode::utf8
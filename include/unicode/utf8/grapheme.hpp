@@ -0,0 +1,145 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <string_view>
+#include <utility>
+
+namespace unicode::utf8
+{
+
+/// Decoded code point
+struct codepoint
+{
+	/// Value of code point
+	char32_t value = 0;
+	/// Size of code point in bytes. 0 for ill-formed sequence
+	size_t size = 0;
+};
+
+/// Decode first code point of UTF-8 string
+constexpr codepoint decode(std::string_view bytes) noexcept
+{
+	if (bytes.empty()) { return {}; }
+
+	auto byte = [&](size_t i) { return static_cast<uint8_t>(bytes[i]); };
+	auto continuation = [&](size_t i)
+	{
+		return i < bytes.size() && (byte(i) & 0xC0) == 0x80;
+	};
+
+	auto lead = byte(0);
+	if (lead < 0x80) { return {lead, 1}; }
+	if (lead < 0xC2) { return {}; }
+	if (lead < 0xE0)
+	{
+		if (!continuation(1)) { return {}; }
+		return {char32_t(lead & 0x1F) << 6 | (byte(1) & 0x3F), 2};
+	}
+	if (lead < 0xF0)
+	{
+		if (!continuation(1) || !continuation(2)) { return {}; }
+		char32_t value =
+			char32_t(lead & 0x0F) << 12 |
+			char32_t(byte(1) & 0x3F) << 6 |
+			(byte(2) & 0x3F);
+		// Overlong sequences and surrogates
+		if (value < 0x800 || (0xD800 <= value && value <= 0xDFFF))
+		{
+			return {};
+		}
+		return {value, 3};
+	}
+	if (lead < 0xF5)
+	{
+		if (!continuation(1) || !continuation(2) || !continuation(3))
+		{
+			return {};
+		}
+		char32_t value =
+			char32_t(lead & 0x07) << 18 |
+			char32_t(byte(1) & 0x3F) << 12 |
+			char32_t(byte(2) & 0x3F) << 6 |
+			(byte(3) & 0x3F);
+		// Overlong sequences and values above unicode range
+		if (value < 0x10000 || value > 0x10FFFF) { return {}; }
+		return {value, 4};
+	}
+	return {};
+}
+
+/// Get size of UTF-8 sequence, that starts with lead byte.
+/// 0 for continuation bytes and bytes, that never start sequences
+constexpr size_t sequence_size(char lead) noexcept
+{
+	auto byte = static_cast<uint8_t>(lead);
+	if (byte < 0x80) { return 1; }
+	if (byte < 0xC2) { return 0; }
+	if (byte < 0xE0) { return 2; }
+	if (byte < 0xF0) { return 3; }
+	return byte < 0xF5 ? 4 : 0;
+}
+
+/// Ranges of code points, that never join with adjacent code points
+/// from the same ranges into one grapheme cluster.
+///
+/// They all have Grapheme_Cluster_Break property Other or Control
+/// and aren't Extended_Pictographic.
+/// Carriage return is excluded, because it's joined with line feed.
+/// Hangul syllables are included, because they only join with jamo
+inline constexpr std::array<std::pair<char32_t, char32_t>, 27>
+standalone_ranges = {{
+	{0x0000, 0x000C}, // ASCII, except CR
+	{0x000E, 0x007F},
+	{0x0080, 0x00A8}, // Latin-1, except (C) and (R) signs
+	{0x00AA, 0x00AD},
+	{0x00AF, 0x02FF}, // Latin Extended, IPA, Spacing Modifiers
+	{0x0370, 0x0482}, // Greek, Cyrillic
+	{0x048A, 0x052F}, // Cyrillic
+	{0x0531, 0x058F}, // Armenian
+	{0x05D0, 0x05F4}, // Hebrew letters
+	{0x10A0, 0x10FF}, // Georgian
+	{0x1E00, 0x1FFF}, // Latin Extended Additional, Greek Extended
+	{0x2010, 0x203B}, // General Punctuation
+	{0x203D, 0x2048},
+	{0x204A, 0x205F},
+	{0x2070, 0x20CF}, // Superscripts, Subscripts, Currency Symbols
+	{0x3000, 0x3029}, // CJK Symbols and Punctuation
+	{0x3031, 0x303C},
+	{0x303E, 0x303F},
+	{0x3041, 0x3096}, // Hiragana, except combining sound marks
+	{0x309B, 0x30FF}, // Hiragana, Katakana
+	{0x3131, 0x318E}, // Hangul Compatibility Jamo
+	{0x3400, 0x9FFF}, // CJK Extension A, Yijing, CJK Unified Ideographs
+	{0xAC00, 0xD7A3}, // Hangul Syllables
+	{0xF900, 0xFAFF}, // CJK Compatibility Ideographs
+	{0xFF01, 0xFF9D}, // Fullwidth forms, except halfwidth sound marks
+	{0xFFA0, 0xFFDC}, // Halfwidth Hangul
+	{0x20000, 0x3FFFF}, // CJK Extensions B-H
+}};
+
+/// Is code point a grapheme cluster on its own,
+/// when it's surrounded by other standalone code points?
+constexpr bool is_standalone(char32_t value) noexcept
+{
+	if (value < 0x80) { return value != '\r'; }
+	// Most frequent scripts, checked before search
+	if (0x0400 <= value && value <= 0x0482) { return true; }
+	if (0x4E00 <= value && value <= 0x9FFF) { return true; }
+
+	auto next = std::upper_bound(
+		standalone_ranges.begin(), standalone_ranges.end(), value,
+		[](char32_t value, auto &range) { return value < range.first; }
+	);
+	return next != standalone_ranges.begin() && value <= (--next)->second;
+}
+
+/// Is code point a regional indicator? 
+/// Pairs of them form flags, so their clusters depend on all preceding ones
+constexpr bool is_regional_indicator(char32_t value) noexcept
+{
+	return 0x1F1E6 <= value && value <= 0x1F1FF;
+}
+
+} // namespace unicode::utf8
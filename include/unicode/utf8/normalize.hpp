@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+
+namespace unicode::utf8
+{
+
+/// Is UTF-8 string in Normalization Form C?
+/// Strings of frequent code points, that never change in normalization,
+/// like ASCII, Latin-1, Cyrillic, kana, CJK and Hangul syllables, 
+/// are checked without ICU
+bool is_nfc(std::string_view bytes) noexcept;
+
+/// Convert UTF-8 string to Normalization Form C.
+/// Ill-formed sequences are replaced with U+FFFD
+std::string to_nfc(std::string_view bytes);
+
+/// Are UTF-8 strings canonically equivalent, i.e. have same NFC form?
+/// @note It's not the equality of utf8::equal(). Collator doesn't 
+/// normalize strings, so it may tell apart canonically equivalent strings,
+/// that aren't in FCD form, like "\u1E9B\u0323" and "\u017F\u0323\u0307",
+/// and it treats as equal strings, that differ by ignorable code points
+bool canonically_equal(std::string_view lhs, std::string_view rhs) noexcept;
+
+/// Get hash of NFC form of UTF-8 string. 
+/// Canonically equivalent strings have same hash
+size_t canonical_hash(std::string_view bytes) noexcept;
+
+} // namespace unicode::utf8
@@ -1,6 +1,8 @@
 #pragma once
 
+#include <algorithm>
 #include <cassert>
+#include <memory_resource>
 #include <vector>
 
 namespace unicode::utility
@@ -253,4 +255,15 @@ private:
 	Comparator comparator;
 };
 
+namespace pmr
+{
+
+/// Sorted vector, that allocates memory from memory resource
+template<typename Value, typename Comparator = std::less<Value>>
+using sorted_vector = utility::sorted_vector<
+	Value, Comparator, std::pmr::polymorphic_allocator<Value>
+>;
+
+} // namespace pmr
+
 } // namespace unicode::utility
@@ -0,0 +1,456 @@
+#include "unicode/collator.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <mutex>
+#include <vector>
+
+#include "unicode/metrics.hpp"
+
+#include "utf8/ascii.hpp"
+
+#include <unicode/coll.h>
+#include <unicode/uniset.h>
+#include <unicode/unistr.h>
+
+using namespace unicode;
+
+namespace
+{
+
+/// Weights of printable ASCII characters for collators, 
+/// that order such strings as sequences of independent characters
+struct ascii_weights
+{
+	/// Can strings be compared with weights?
+	bool enabled = false;
+	/// Do all characters have different weights?
+	bool distinct = false;
+	/// Rank of primary weight of character
+	std::array<uint8_t, 128> primary{};
+	/// Rank of character among characters with same primary weight
+	std::array<uint8_t, 128> tertiary{};
+
+	/// Compare printable ASCII strings like collator with given strength
+	std::strong_ordering compare(
+		std::string_view lhs,
+		std::string_view rhs,
+		collation_strength strength
+	) const noexcept
+	{
+		auto common = std::min(lhs.size(), rhs.size());
+		for (size_t i = 0; i < common; ++i)
+		{
+			auto l = primary[uint8_t(lhs[i])], r = primary[uint8_t(rhs[i])];
+			if (l != r) { return l <=> r; }
+		}
+		if (lhs.size() != rhs.size()) { return lhs.size() <=> rhs.size(); }
+		if (strength < collation_strength::tertiary)
+		{
+			return std::strong_ordering::equal;
+		}
+
+		for (size_t i = 0; i < common; ++i)
+		{
+			auto l = tertiary[uint8_t(lhs[i])], r = tertiary[uint8_t(rhs[i])];
+			if (l != r) { return l <=> r; }
+		}
+		if (strength < collation_strength::identical)
+		{
+			return std::strong_ordering::equal;
+		}
+		return lhs.compare(rhs) <=> 0;
+	}
+
+	/// Build weights for collator. 
+	/// Weights are disabled, if collator has ASCII tailoring, contractions,
+	/// numeric ordering or ignorable ASCII characters
+	static ascii_weights of(
+		const icu::Collator &coll, 
+		collation_strength strength
+	) noexcept;
+};
+
+} // namespace
+
+/// ICU related state of collator
+struct collator::implementation
+{
+	/// ICU collator
+	std::unique_ptr<icu::Collator> icu;
+	/// Strength of comparison
+	collation_strength strength;
+
+	/// Get weights for fast comparison of printable ASCII strings
+	const ascii_weights &ascii() noexcept
+	{
+		std::call_once(
+			ascii_built, 
+			[this] { ascii_table = ascii_weights::of(*icu, strength); }
+		);
+		return ascii_table;
+	}
+
+	/// Are weights built?
+	std::once_flag ascii_built;
+	/// Weights for fast comparison of printable ASCII strings
+	ascii_weights ascii_table;
+};
+
+namespace
+{
+
+/// Generation of cached collators. Incremented on invalidation
+std::atomic<uint64_t> cache_generation{0};
+
+/// Collators, cached by single thread
+struct collator_cache
+{
+	/// Generation of collators in cache
+	uint64_t generation = 0;
+	/// Collators for default locale, by strength
+	std::array<std::unique_ptr<collator>, 5> defaults;
+	/// Collators for other locales
+	std::vector<std::unique_ptr<collator>> others;
+
+	/// Drop collators, if cache was invalidated
+	void refresh() noexcept
+	{
+		auto current = cache_generation.load(std::memory_order_relaxed);
+		if (current == generation) { return; }
+
+		defaults = {};
+		others.clear();
+		generation = current;
+	}
+};
+
+/// Collators, cached by current thread
+thread_local collator_cache cache;
+
+/// Convert strength to ICU attribute value
+UColAttributeValue to_icu(collation_strength strength) noexcept
+{
+	switch (strength)
+	{
+	case collation_strength::primary: return UCOL_PRIMARY;
+	case collation_strength::secondary: return UCOL_SECONDARY;
+	case collation_strength::tertiary: return UCOL_TERTIARY;
+	case collation_strength::quaternary: return UCOL_QUATERNARY;
+	case collation_strength::identical: return UCOL_IDENTICAL;
+	}
+	return UCOL_DEFAULT;
+}
+
+} // namespace
+
+/// Create collator for locale. Empty locale means default locale
+collator::collator(
+	std::string_view locale,
+	collation_strength strength
+) noexcept
+	: locale_name(locale), level(strength)
+{
+	metrics::add(metrics::counter::collators_created);
+	metrics::icu_timer timer;
+	UErrorCode errorCode = U_ZERO_ERROR;
+	std::unique_ptr<icu::Collator> coll{
+		icu::Collator::createInstance(
+			locale_name.empty() ?
+				icu::Locale::getDefault() :
+				icu::Locale(locale_name.c_str()),
+			errorCode
+		)
+	};
+	if (U_FAILURE(errorCode))
+	{
+		assert(false && "coudn't create collator");
+		return;
+	}
+
+	errorCode = U_ZERO_ERROR;
+	coll->setAttribute(UCOL_STRENGTH, to_icu(strength), errorCode);
+	if (U_FAILURE(errorCode))
+	{
+		assert(false && "coudn't set collator strength");
+		return;
+	}
+
+	impl = std::make_unique<implementation>();
+	impl->icu = std::move(coll);
+	impl->strength = strength;
+}
+
+collator::collator(collator &&) noexcept = default;
+collator &collator::operator=(collator &&) noexcept = default;
+collator::~collator() = default;
+
+/// Get collator cached by current thread
+const collator &collator::cached(
+	std::string_view locale,
+	collation_strength strength
+) noexcept
+{
+	cache.refresh();
+
+	if (locale.empty())
+	{
+		auto &coll = cache.defaults[static_cast<size_t>(strength)];
+		if (!coll) { coll = std::make_unique<collator>(locale, strength); }
+		return *coll;
+	}
+
+	for (auto &coll : cache.others)
+	{
+		if (coll->strength() == strength && coll->locale() == locale)
+		{
+			return *coll;
+		}
+	}
+	return *cache.others.emplace_back(
+		std::make_unique<collator>(locale, strength)
+	);
+}
+
+/// Drop collators cached by all threads
+void collator::invalidate_cache() noexcept
+{
+	cache_generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+/// Compare two UTF-8 strings
+std::strong_ordering collator::compare(
+	std::string_view lhs,
+	std::string_view rhs
+) const noexcept
+{
+	if (!impl)
+	{
+		assert(false && "coudn't create collator");
+		/// Fallback to byte comparison
+		return lhs.compare(rhs) <=> 0;
+	}
+
+	metrics::add(metrics::counter::comparisons);
+	if (lhs == rhs) 
+	{
+		metrics::add(metrics::counter::comparisons_identical);
+		return std::strong_ordering::equal; 
+	}
+
+	if (utf8::is_printable_ascii(lhs) && utf8::is_printable_ascii(rhs))
+	{
+		auto &ascii = impl->ascii();
+		if (ascii.enabled) 
+		{ 
+			metrics::add(metrics::counter::comparisons_ascii);
+			return ascii.compare(lhs, rhs, level); 
+		}
+	}
+
+	metrics::add(metrics::counter::comparisons_icu);
+	metrics::icu_timer timer;
+	UErrorCode errorCode = U_ZERO_ERROR;
+	auto res = impl->icu->compareUTF8(lhs, rhs, errorCode);
+	if (U_FAILURE(errorCode))
+	{
+		assert(false && "collator error");
+		/// Fallback to byte comparison
+		return lhs.compare(rhs) <=> 0;
+	}
+
+	return res <=> 0;
+}
+
+/// Check that two UTF-8 strings are equal
+bool collator::equal(
+	std::string_view lhs,
+	std::string_view rhs
+) const noexcept
+{
+	if (lhs == rhs) 
+	{
+		metrics::add(metrics::counter::comparisons);
+		metrics::add(metrics::counter::comparisons_identical);
+		return true; 
+	}
+
+	if (
+		impl &&
+		level >= collation_strength::tertiary &&
+		utf8::is_printable_ascii(lhs) && 
+		utf8::is_printable_ascii(rhs)
+	)
+	{
+		auto &ascii = impl->ascii();
+		if (ascii.enabled && ascii.distinct) 
+		{ 
+			metrics::add(metrics::counter::comparisons);
+			metrics::add(metrics::counter::comparisons_ascii);
+			return false; 
+		}
+	}
+	return compare(lhs, rhs) == 0;
+}
+
+/// Are printable ASCII strings compared without ICU?
+bool collator::has_ascii_fast_path() const noexcept
+{
+	return impl && impl->ascii().enabled;
+}
+
+/// Write sort key of UTF-8 string to buffer, if it fits
+size_t collator::write_sort_key(
+	std::string_view string,
+	uint8_t *buffer,
+	size_t capacity
+) const noexcept
+{
+	if (!impl)
+	{
+		assert(false && "coudn't create collator");
+		return 0;
+	}
+
+	metrics::icu_timer timer;
+	auto size = impl->icu->getSortKey(
+		icu::UnicodeString::fromUTF8(string),
+		buffer,
+		static_cast<int32_t>(std::min<size_t>(capacity, INT32_MAX))
+	);
+	return static_cast<size_t>(size);
+}
+
+/// Build weights of printable ASCII characters for collator
+ascii_weights ascii_weights::of(
+	const icu::Collator &coll, 
+	collation_strength strength
+) noexcept
+{
+	UErrorCode errorCode = U_ZERO_ERROR;
+	auto attribute = [&](UColAttribute attr)
+	{
+		return coll.getAttribute(attr, errorCode);
+	};
+	if (
+		attribute(UCOL_NUMERIC_COLLATION) != UCOL_OFF ||
+		attribute(UCOL_ALTERNATE_HANDLING) != UCOL_NON_IGNORABLE ||
+		attribute(UCOL_CASE_LEVEL) != UCOL_OFF ||
+		U_FAILURE(errorCode)
+	)
+	{
+		return {};
+	}
+
+	std::unique_ptr<icu::UnicodeSet> tailored{coll.getTailoredSet(errorCode)};
+	if (U_FAILURE(errorCode) || !tailored || tailored->containsSome(0x20, 0x7E))
+	{
+		return {};
+	}
+
+	auto icu_compare = [&](const icu::Collator &coll, auto lhs, auto rhs)
+	{
+		UErrorCode errorCode = U_ZERO_ERROR;
+		auto res = coll.compareUTF8(
+			std::string_view(lhs), std::string_view(rhs), errorCode
+		);
+		return U_FAILURE(errorCode) ? UCOL_EQUAL : res;
+	};
+
+	std::vector<std::string> characters;
+	for (char c = 0x20; c <= 0x7E; ++c)
+	{
+		characters.emplace_back(1, c);
+		if (icu_compare(coll, characters.back(), "") == UCOL_EQUAL)
+		{
+			// Ignorable characters can't be compared one by one
+			return {};
+		}
+	}
+	std::stable_sort(
+		characters.begin(), characters.end(),
+		[&](auto &lhs, auto &rhs) 
+		{ 
+			return icu_compare(coll, lhs, rhs) == UCOL_LESS; 
+		}
+	);
+
+	std::unique_ptr<icu::Collator> primary{coll.clone()};
+	std::unique_ptr<icu::Collator> secondary{coll.clone()};
+	if (!primary || !secondary) { return {}; }
+	primary->setAttribute(UCOL_STRENGTH, UCOL_PRIMARY, errorCode);
+	secondary->setAttribute(UCOL_STRENGTH, UCOL_SECONDARY, errorCode);
+	if (U_FAILURE(errorCode)) { return {}; }
+
+	ascii_weights weights;
+	weights.distinct = true;
+	std::string_view group = characters.front();
+	for (size_t i = 1; i < characters.size(); ++i)
+	{
+		auto &previous = characters[i - 1];
+		auto &current = characters[i];
+		auto c = uint8_t(current.front());
+
+		if (icu_compare(*primary, previous, current) != UCOL_EQUAL)
+		{
+			group = current;
+			weights.primary[c] = weights.primary[uint8_t(previous.front())] + 1;
+			continue;
+		}
+
+		// Secondary differences inside of group aren't supported
+		if (icu_compare(*secondary, group, current) != UCOL_EQUAL)
+		{
+			return {};
+		}
+
+		weights.primary[c] = weights.primary[uint8_t(previous.front())];
+		weights.tertiary[c] = weights.tertiary[uint8_t(previous.front())];
+		if (icu_compare(coll, previous, current) != UCOL_EQUAL)
+		{
+			++weights.tertiary[c];
+		}
+		else
+		{
+			weights.distinct = false;
+		}
+	}
+
+	// Check, that strings of 1 and 2 characters are ordered same way.
+	// This finds contractions, expansions and other context-dependent rules
+	std::vector<std::string> strings;
+	strings.reserve(95 * 96);
+	for (char c = 0x20; c <= 0x7E; ++c)
+	{
+		strings.emplace_back(1, c);
+		for (char d = 0x20; d <= 0x7E; ++d)
+		{
+			strings.push_back({c, d});
+		}
+	}
+	std::sort(
+		strings.begin(), strings.end(),
+		[&](auto &lhs, auto &rhs) 
+		{ 
+			return weights.compare(lhs, rhs, strength) < 0; 
+		}
+	);
+	for (size_t i = 1; i < strings.size(); ++i)
+	{
+		auto expected = weights.compare(strings[i - 1], strings[i], strength);
+		auto actual = icu_compare(coll, strings[i - 1], strings[i]);
+		if ((expected == 0) != (actual == UCOL_EQUAL))
+		{
+			return {};
+		}
+		if (expected < 0 && actual != UCOL_LESS)
+		{
+			return {};
+		}
+	}
+
+	weights.enabled = true;
+	return weights;
+}
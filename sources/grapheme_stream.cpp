@@ -0,0 +1,91 @@
+#include "unicode/grapheme_stream.hpp"
+
+#include "unicode/utf8/grapheme.hpp"
+
+using namespace unicode;
+
+namespace
+{
+
+/// Can following bytes change code point at position?
+bool is_complete_codepoint(std::string_view text, size_t position) noexcept
+{
+	return 
+		text.size() - position >= 4 || 
+		utf8::decode(text.substr(position)).size != 0;
+}
+
+/// Is there regional indicator right before position?
+bool regional_indicator_before(std::string_view text, size_t position) noexcept
+{
+	if (position < 4) { return false; }
+	auto codepoint = utf8::decode(text.substr(position - 4, 4));
+	return codepoint.size == 4 && utf8::is_regional_indicator(codepoint.value);
+}
+
+} // namespace
+
+/// Split carried text with chunk into characters
+grapheme_stream::pending_text grapheme_stream::prepare(
+	std::string_view chunk,
+	bool last
+) noexcept
+{
+	std::string_view text = chunk;
+	if (!carry.empty())
+	{
+		carry += chunk;
+		text = carry;
+	}
+
+	blocks.truncate(0);
+	layout_progress progress;
+	layout_builder::current().extend(blocks, text, progress, text.size());
+	if (last)
+	{
+		return {
+			.bytes = text, 
+			.characters = progress.characters, 
+			.complete_bytes = text.size()
+		};
+	}
+
+	// Boundary before character depends only on preceding text and
+	// the first code point of character, so it's final, 
+	// once that code point is complete. Splitting can restart there,
+	// unless regional indicators before it may pair with following ones
+	for (auto character = progress.characters; character-- > 1;)
+	{
+		auto [index, offset, block] = blocks.block_for_character(character);
+		auto begin = 
+			block.byte_offset + (character - offset) * block.character_size;
+		if (
+			is_complete_codepoint(text, begin) && 
+			!regional_indicator_before(text, begin)
+		)
+		{
+			return {
+				.bytes = text, 
+				.characters = character, 
+				.complete_bytes = begin
+			};
+		}
+	}
+	return {.bytes = text};
+}
+
+/// Keep the rest of text for following chunks
+void grapheme_stream::keep_tail(const pending_text &text)
+{
+	emitted.characters += text.characters;
+	emitted.bytes += text.complete_bytes;
+
+	if (!carry.empty() && text.bytes.data() == carry.data())
+	{
+		carry.erase(0, text.complete_bytes);
+	}
+	else
+	{
+		carry.assign(text.bytes.substr(text.complete_bytes));
+	}
+}
@@ -5,9 +5,9 @@
 #include <unicode/utext.h>
 #include <unicode/brkiter.h>
 
-/// Get character break iterator at the beginning of openned unicode text 
+/// Create character break iterator without text
 inline std::unique_ptr<icu::BreakIterator> 
-getCharacterBreakIterator(UText *utext) noexcept
+createCharacterBreakIterator() noexcept
 {
 	UErrorCode errorCode = U_ZERO_ERROR;
 	std::unique_ptr<icu::BreakIterator> it {
@@ -20,8 +20,20 @@ getCharacterBreakIterator(UText *utext) noexcept
 	{
 		return nullptr;
 	}
+	return it;
+}
 
-	errorCode = U_ZERO_ERROR;
+/// Get character break iterator at the beginning of openned unicode text 
+inline std::unique_ptr<icu::BreakIterator> 
+getCharacterBreakIterator(UText *utext) noexcept
+{
+	auto it = createCharacterBreakIterator();
+	if (!it)
+	{
+		return nullptr;
+	}
+
+	UErrorCode errorCode = U_ZERO_ERROR;
 	it->setText(utext, errorCode);
 	if (U_FAILURE(errorCode))
 	{
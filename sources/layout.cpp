@@ -1,46 +1,1125 @@
 #include "unicode/layout.hpp"
 
+#include <algorithm>
 #include <cassert>
+#include <latch>
+#include <mutex>
+#include <vector>
+
+#include "unicode/utf8/grapheme.hpp"
 
 #include "icu.hpp"
+#include "utf8/ascii.hpp"
 
 using namespace unicode;
 
-/// Get layout of string
-layout layout::of(std::string_view bytes) noexcept
+namespace
 {
-	if (bytes.empty()) { return {}; }
-
-	layout layout;
-
-	auto utext = openUText(bytes);
-	assert(utext);
 
-	auto it = getCharacterBreakIterator(utext.get());
+/// Appends characters to the end of layout, merging them into blocks
+class layout_appender
+{
+public:
+	/// Append characters to layout, that already has some characters
+	layout_appender(layout &result, layout_progress progress) noexcept
+		: result(result),
+		previous_character_size(
+			result.empty() ? 0 : result.back().character_size
+		),
+		characters(progress.characters),
+		bytes(progress.bytes)
+	{}
 
-	size_t offset = 0;
-	size_t previous_character_size = 0;
-	for (
-		auto start = it->first(), end = it->next();
-		end != icu::BreakIterator::DONE;
-		start = end, end = it->next(), ++offset
-	)
+	/// Append characters of same size
+	void append(size_t character_size, size_t count = 1) noexcept
 	{
-		size_t character_size = end - start;
+		if (count == 0) { return; }
 
 		if (character_size != previous_character_size)
 		{
-			layout.offsets.push_back(offset);
-			layout.blocks.push_back(
+			result.push_back(
+				characters,
 				block{
 					.character_size = character_size,
-					.byte_offset = size_t(start)
+					.byte_offset = bytes
 				}
 			);
 			previous_character_size = character_size;
 		}
+		characters += count;
+		bytes += count * character_size;
+	}
+
+	/// Get offset of the first byte after appended characters
+	size_t byte_offset() const noexcept { return bytes; }
+
+	/// Get number of characters and bytes inside of layout
+	layout_progress progress() const noexcept
+	{
+		return {.characters = characters, .bytes = bytes};
+	}
+
+private:
+	/// Layout to append to
+	layout &result;
+	/// Size of characters inside of last block
+	size_t previous_character_size = 0;
+	/// Number of appended characters
+	size_t characters = 0;
+	/// Number of appended bytes
+	size_t bytes = 0;
+};
+
+/// Get size of standalone code point at the beginning of bytes.
+/// @return 0, if there is no such code point
+size_t standalone_size(std::string_view bytes) noexcept
+{
+	auto codepoint = utf8::decode(bytes);
+	return codepoint.size != 0 && utf8::is_standalone(codepoint.value) ?
+		codepoint.size : 0;
+}
+
+/// Run of standalone non-ASCII code points with same size
+struct standalone_run
+{
+	/// Size of code points
+	size_t size = 0;
+	/// Number of code points
+	size_t count = 0;
+};
+
+/// Get run of standalone non-ASCII code points at the beginning of bytes.
+/// Run stops after limit in bytes is reached
+standalone_run standalone_run_at(
+	std::string_view bytes, 
+	size_t limit
+) noexcept
+{
+	standalone_run run{.size = standalone_size(bytes)};
+	if (run.size < 2) { return {}; }
+
+	size_t position = 0;
+	do
+	{
+		++run.count;
+		position += run.size;
+	} while (
+		position < std::min(bytes.size(), limit) &&
+		static_cast<uint8_t>(bytes[position]) >= 0x80 &&
+		standalone_size(bytes.substr(position)) == run.size
+	);
+	return run;
+}
+
+/// Find end of text, that needs full grapheme cluster rules.
+/// It ends before carriage return or between two standalone code points.
+/// Offset of the first ill-formed sequence is written to ill_formed,
+/// if it's not null
+size_t complex_span_end(
+	std::string_view bytes, 
+	size_t position,
+	size_t *ill_formed = nullptr
+) noexcept
+{
+	while (position < bytes.size() && bytes[position] != '\r')
+	{
+		auto size = standalone_size(bytes.substr(position));
+		if (size == 0)
+		{
+			auto codepoint = utf8::decode(bytes.substr(position));
+			if (codepoint.size == 0 && ill_formed && *ill_formed == SIZE_MAX)
+			{
+				*ill_formed = position;
+			}
+			position += std::max<size_t>(codepoint.size, 1);
+			continue;
+		}
+
+		position += size;
+		if (
+			position == bytes.size() ||
+			bytes[position] == '\r' ||
+			standalone_size(bytes.substr(position)) != 0
+		)
+		{
+			return position;
+		}
+	}
+	return position;
+}
+
+/// Is there regional indicator at position?
+bool regional_indicator_at(std::string_view bytes, size_t position) noexcept
+{
+	auto codepoint = utf8::decode(bytes.substr(position, 4));
+	return codepoint.size == 4 && utf8::is_regional_indicator(codepoint.value);
+}
+
+/// Find the last character boundary before limit, 
+/// where characters can be split again without looking back.
+///
+/// Boundary depends only on preceding text and the code point after it,
+/// so it stays the same, while that code point is before limit.
+/// Only pairs of regional indicators look further back
+layout_progress restart_point(
+	const layout &layout,
+	std::string_view bytes,
+	size_t limit
+) noexcept
+{
+	if (limit == 0 || layout.empty()) { return {}; }
+
+	auto [block_index, offset, block] = layout.block_for_byte(limit - 1);
+	auto character = 
+		offset + (limit - 1 - block.byte_offset) / block.character_size;
+	while (character != 0)
+	{
+		if (character < offset)
+		{
+			--block_index;
+			offset = layout.offset(block_index);
+			block = layout[block_index];
+		}
+
+		auto begin = 
+			block.byte_offset + (character - offset) * block.character_size;
+		auto codepoint = utf8::decode(bytes.substr(begin));
+		if (
+			begin + std::max<size_t>(codepoint.size, 1) <= limit &&
+			(begin < 4 || !regional_indicator_at(bytes, begin - 4))
+		)
+		{
+			return {.characters = character, .bytes = begin};
+		}
+		--character;
+	}
+	return {};
+}
+
+/// Is there boundary at position, that doesn't depend on surrounding text?
+/// It's true after line feed and between two standalone code points
+bool is_independent_boundary(std::string_view bytes, size_t position) noexcept
+{
+	if (position == 0 || position == bytes.size()) { return true; }
+	if (bytes[position - 1] == '\n') { return true; }
+
+	auto after = utf8::decode(bytes.substr(position));
+	if (after.size == 0 || !utf8::is_standalone(after.value)) { return false; }
+
+	auto start = position - 1;
+	while (
+		start > 0 && position - start < 4 && 
+		(static_cast<uint8_t>(bytes[start]) & 0xC0) == 0x80
+	)
+	{
+		--start;
+	}
+	auto before = utf8::decode(bytes.substr(start, position - start));
+	return 
+		before.size == position - start && 
+		utf8::is_standalone(before.value);
+}
+
+/// Find the first independent boundary at or after position
+size_t next_independent_boundary(
+	std::string_view bytes, 
+	size_t position
+) noexcept
+{
+	while (!is_independent_boundary(bytes, position)) { ++position; }
+	return position;
+}
+
+/// Get character break iterator, which is cloned for each thread
+std::unique_ptr<icu::BreakIterator> clone_character_break_iterator() noexcept
+{
+	static std::mutex mutex;
+	static const auto prototype = createCharacterBreakIterator();
+
+	std::lock_guard lock(mutex);
+	if (!prototype) { return nullptr; }
+	return std::unique_ptr<icu::BreakIterator>(prototype->clone());
+}
+
+} // namespace
+
+layout::layout(const layout &other, std::pmr::memory_resource *resource)
+	: width(other.width), local(true), resource(resource)
+{
+	if (other.sampled)
+	{
+		auto size = other.heap_size();
+		heap.data = static_cast<std::byte *>(
+			resource->allocate(size, alignof(uint64_t))
+		);
+		heap.capacity = other.heap.capacity;
+		std::memcpy(heap.data, other.heap.data, size);
+		local = false;
+		sampled = true;
+		count = other.count;
+		return;
+	}
+
+	reallocate(other.count, width, other.indexed);
+	count = other.count;
+	for (auto array : {offsets, byte_offsets, character_sizes})
+	{
+		std::memcpy(
+			data() + array * capacity() * width,
+			other.data() + array * other.capacity() * width,
+			count * width
+		);
+	}
+	if (other.indexed) { build_index(); }
+}
+
+layout::layout(layout &&other) noexcept
+	: count(other.count), 
+	width(other.width), 
+	local(other.local), 
+	index_space(other.index_space),
+	indexed(other.indexed),
+	sampled(other.sampled),
+	resource(other.resource)
+{
+	std::memcpy(inline_data, other.inline_data, inline_size);
+	other.local = true;
+	other.index_space = false;
+	other.indexed = false;
+	other.sampled = false;
+	other.count = 0;
+}
+
+layout &layout::operator=(const layout &other)
+{
+	if (this != &other) { *this = layout(other, resource); }
+	return *this;
+}
+
+layout &layout::operator=(layout &&other) noexcept
+{
+	if (this == &other) { return *this; }
+
+	// Memory of other resource can't be freed by own resource
+	if (!other.local && !resource->is_equal(*other.resource))
+	{
+		*this = layout(other, resource);
+		other.clear();
+		return *this;
+	}
+
+	deallocate();
+	count = other.count;
+	width = other.width;
+	local = other.local;
+	index_space = other.index_space;
+	indexed = other.indexed;
+	sampled = other.sampled;
+	std::memcpy(inline_data, other.inline_data, inline_size);
+	other.local = true;
+	other.index_space = false;
+	other.indexed = false;
+	other.sampled = false;
+	other.count = 0;
+	return *this;
+}
+
+/// Add block to the end of layout
+void layout::push_back(size_t offset, block block) noexcept
+{
+	if (sampled) { unsample(); }
+	assert(
+		(count == 0 || offset > this->offset(count - 1)) && 
+		"block added at wrong position"
+	);
+
+	auto required_width = width_for(
+		std::max({offset, block.byte_offset, block.character_size})
+	);
+	if (required_width > width)
+	{
+		reallocate(std::max(count + 1, capacity()), required_width);
+	}
+	if (count == capacity())
+	{
+		reallocate(std::max<size_t>(2 * count, 8));
+	}
+
+	store(offsets, count, offset);
+	store(byte_offsets, count, block.byte_offset);
+	store(character_sizes, count, block.character_size);
+	++count;
+	indexed = false;
+}
+
+/// Release unused memory, storing layout with specified strategy
+void layout::shrink_to_fit(layout_strategy strategy) noexcept
+{
+	// Layouts are shrinked, when they are complete
+	if (!sampled) { metrics::add_layout(count); }
+
+	if (strategy == layout_strategy::automatic && count >= indexed_size)
+	{
+		// Sampled layout takes about one byte per character, 
+		// while each block takes three or four integers
+		auto characters = offset(count - 1);
+		strategy = 4 * count >= characters ? 
+			layout_strategy::sampled : layout_strategy::blocks;
+	}
+
+	if (strategy == layout_strategy::sampled)
+	{
+		if (!sampled) { sample(); }
+		if (sampled) { return; }
+	}
+	if (sampled) { unsample(); }
+
+	auto with_index = count >= indexed_size;
+	reallocate(count, width, with_index);
+	if (with_index) { build_index(); }
+}
+
+/// Store blocks as sampled layout, if they can be sampled.
+/// Blocks must start from the first character and byte, follow 
+/// each other without gaps and have characters up to 255 bytes
+void layout::sample() noexcept
+{
+	if (count == 0) { return; }
+
+	auto characters = offset(count - 1);
+	for (size_t i = 0; i + 1 < count; ++i)
+	{
+		auto block = (*this)[i];
+		auto end = 
+			block.byte_offset + 
+			(offset(i + 1) - offset(i)) * block.character_size;
+		if (
+			block.character_size > UINT8_MAX || 
+			block.character_size == 0 || 
+			end != load(byte_offsets, i + 1)
+		)
+		{
+			return;
+		}
+	}
+	if (offset(0) != 0 || load(byte_offsets, 0) != 0) { return; }
+
+	auto size = sampled_storage_size(characters + 1, width);
+	auto *storage = static_cast<std::byte *>(
+		resource->allocate(size, alignof(uint64_t))
+	);
+	auto samples = (characters + sample_size - 1) / sample_size;
+	auto *sizes = reinterpret_cast<uint8_t *>(
+		storage + (2 + samples) * width
+	);
+	size_t byte_offset = 0;
+	for (size_t i = 0, character = 0; i + 1 < count; ++i)
+	{
+		auto character_size = load(character_sizes, i);
+		for (auto end = offset(i + 1); character < end; ++character)
+		{
+			if (character % sample_size == 0)
+			{
+				store_value(
+					storage + (2 + character / sample_size) * width, 
+					byte_offset,
+					width
+				);
+			}
+			sizes[character] = static_cast<uint8_t>(character_size);
+			byte_offset += character_size;
+		}
+	}
+	auto last = back();
+	store_value(storage, last.character_size, width);
+	store_value(storage + width, last.byte_offset, width);
+
+	deallocate();
+	local = false;
+	sampled = true;
+	heap.data = storage;
+	heap.capacity = characters + 1;
+	count = characters + 1;
+}
+
+/// Store sampled layout as blocks
+void layout::unsample() noexcept
+{
+	assert(sampled && "layout isn't sampled");
+
+	layout result(resource);
+	result.width = width;
+	auto *sizes = sampled_sizes();
+	size_t byte_offset = 0;
+	for (size_t i = 0; i + 1 < count; ++i)
+	{
+		if (result.empty() || result.back().character_size != sizes[i])
+		{
+			result.push_back(
+				i, {.character_size = sizes[i], .byte_offset = byte_offset}
+			);
+		}
+		byte_offset += sizes[i];
+	}
+	auto last = back();
+	if (result.empty() || result.back().character_size != last.character_size)
+	{
+		result.push_back(count - 1, last);
+	}
+	*this = std::move(result);
+}
+
+/// Get block of sampled layout, that contains byte
+block_position layout::sampled_block_for_byte(
+	size_t byte_offset
+) const noexcept
+{
+	auto last = sampled_block_for(count - 1);
+	if (byte_offset >= last.block.byte_offset) { return last; }
+
+	// Find the last sample before byte, then add sizes of characters
+	auto characters = count - 1;
+	auto samples = (characters + sample_size - 1) / sample_size;
+	size_t low = 0, high = samples;
+	while (high - low > 1)
+	{
+		auto middle = (low + high) / 2;
+		auto sample = load_value(heap.data + (2 + middle) * width);
+		(sample <= byte_offset ? low : high) = middle;
+	}
+
+	auto *sizes = sampled_sizes();
+	auto character = low * sample_size;
+	auto begin = load_value(heap.data + (2 + low) * width);
+	while (begin + sizes[character] <= byte_offset)
+	{
+		begin += sizes[character++];
+	}
+	return {
+		.index = character,
+		.offset = character,
+		.block = {.character_size = sizes[character], .byte_offset = begin}
+	};
+}
+
+/// Build search index in Eytzinger order of offsets
+void layout::build_index() noexcept
+{
+	assert(!local && index_space && "no space for index");
+
+	// In-order traversal of tree visits offsets in sorted order
+	size_t next = 0;
+	auto fill = [&](auto &fill, size_t node) -> void
+	{
+		if (node > count) { return; }
+		fill(fill, 2 * node);
+		store(search_index, node, load(offsets, next++));
+		fill(fill, 2 * node + 1);
+	};
+	fill(fill, 1);
+	indexed = true;
+}
+
+/// Layouts are equal, if they have same blocks
+bool layout::operator==(const layout &other) const noexcept
+{
+	if (sampled || other.sampled)
+	{
+		layout lhs(*this), rhs(other);
+		if (lhs.sampled) { lhs.unsample(); }
+		if (rhs.sampled) { rhs.unsample(); }
+		return lhs == rhs;
+	}
+	if (count != other.count) { return false; }
+
+	for (size_t i = 0; i < count; ++i)
+	{
+		if (
+			offset(i) != other.offset(i) ||
+			(*this)[i].character_size != other[i].character_size ||
+			(*this)[i].byte_offset != other[i].byte_offset
+		)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+/// Write blocks to buffer as three arrays of integers
+void layout::serialize(std::byte *buffer) const noexcept
+{
+	// Buffer of empty layout may be null
+	if (count == 0) { return; }
+	if (sampled)
+	{
+		for (size_t i = 0; i < count; ++i)
+		{
+			auto *address = buffer + i * width;
+			auto block = (*this)[i];
+			store_value(address, offset(i), width);
+			store_value(
+				address + byte_offsets * count * width, block.byte_offset, width
+			);
+			store_value(
+				address + character_sizes * count * width, 
+				block.character_size, 
+				width
+			);
+		}
+		return;
+	}
+
+	for (auto array : {offsets, byte_offsets, character_sizes})
+	{
+		std::memcpy(
+			buffer + array * count * width,
+			data() + array * capacity() * width,
+			count * width
+		);
+	}
+}
+
+/// Read blocks, written by serialize()
+layout layout::deserialize(
+	std::span<const std::byte> data,
+	size_t block_count,
+	size_t integer_width
+) noexcept
+{
+	if (
+		(integer_width != 2 && integer_width != 4 && integer_width != 8) ||
+		data.size() / 3 / integer_width < block_count ||
+		data.size() != block_count * 3 * integer_width
+	)
+	{
+		return {};
+	}
+	// Data of empty layout may be null
+	if (block_count == 0) { return {}; }
+
+	layout result;
+	result.width = static_cast<uint8_t>(integer_width);
+	result.reallocate(block_count, result.width);
+	for (auto array : {offsets, byte_offsets, character_sizes})
+	{
+		std::memcpy(
+			result.data() + array * result.capacity() * integer_width,
+			data.data() + array * block_count * integer_width,
+			block_count * integer_width
+		);
+	}
+	result.count = block_count;
+	result.shrink_to_fit();
+	return result;
+}
+
+/// Store integer with specified width
+void layout::store_value(
+	std::byte *address, 
+	size_t value, 
+	uint8_t width
+) noexcept
+{
+	switch (width)
+	{
+	case 2: 
+	{
+		auto narrow = static_cast<uint16_t>(value);
+		std::memcpy(address, &narrow, sizeof(narrow));
+		break;
+	}
+	case 4: 
+	{
+		auto narrow = static_cast<uint32_t>(value);
+		std::memcpy(address, &narrow, sizeof(narrow));
+		break;
+	}
+	default:
+	{
+		auto wide = static_cast<uint64_t>(value);
+		std::memcpy(address, &wide, sizeof(wide));
+		break;
+	}
+	}
+}
+
+/// Move blocks to storage with new capacity and integer width
+void layout::reallocate(
+	size_t new_capacity, 
+	uint8_t new_width,
+	bool with_index_space
+) noexcept
+{
+	assert(new_capacity >= count && "blocks don't fit into storage");
+
+	auto inline_capacity = inline_size / (3 * new_width);
+	auto fits_inline = new_capacity <= inline_capacity && !with_index_space;
+	auto same_storage = 
+		fits_inline ? 
+			local : 
+			!local && 
+			new_capacity == heap.capacity && 
+			index_space == with_index_space;
+	if (new_width == width && same_storage) { return; }
+
+	layout result(resource);
+	result.width = new_width;
+	if (!fits_inline)
+	{
+		result.local = false;
+		result.index_space = with_index_space;
+		result.heap.data = static_cast<std::byte *>(
+			resource->allocate(
+				storage_size(new_capacity, new_width, with_index_space), 
+				alignof(uint64_t)
+			)
+		);
+		result.heap.capacity = new_capacity;
+	}
+	for (auto array : {offsets, byte_offsets, character_sizes})
+	{
+		if (new_width == width)
+		{
+			std::memcpy(
+				result.data() + array * result.capacity() * width,
+				data() + array * capacity() * width,
+				count * width
+			);
+			continue;
+		}
+		for (size_t i = 0; i < count; ++i)
+		{
+			result.store(array, i, load(array, i));
+		}
+	}
+	result.count = count;
+	*this = std::move(result);
+}
+
+/// Segments text with full grapheme cluster rules of ICU
+struct layout_builder::implementation
+{
+	/// Unicode text over current span
+	decltype(openUText({})) utext = openUText({});
+	/// Character break iterator over current span
+	std::unique_ptr<icu::BreakIterator> it = clone_character_break_iterator();
+
+	/// Append characters of text, that starts and ends at cluster boundary
+	void segment(std::string_view text, layout_appender &appender) noexcept
+	{
+		assert(utext && it && "couldn't create break iterator");
+		if (!utext || !it) { return; }
+
+		metrics::add(metrics::counter::bytes_segmented_by_icu, text.size());
+		metrics::icu_timer timer;
+
+		UErrorCode errorCode = U_ZERO_ERROR;
+		utext_openUTF8(utext.get(), text.data(), text.size(), &errorCode);
+		it->setText(utext.get(), errorCode);
+		if (U_FAILURE(errorCode))
+		{
+			assert(false && "couldn't set text of break iterator");
+			return;
+		}
+
+		for (
+			auto start = it->first(), end = it->next();
+			end != icu::BreakIterator::DONE;
+			start = end, end = it->next()
+		)
+		{
+			appender.append(end - start);
+		}
+	}
+};
+
+layout_builder::layout_builder() noexcept = default;
+layout_builder::layout_builder(layout_builder &&) noexcept = default;
+layout_builder &layout_builder::operator=(layout_builder &&) noexcept = default;
+layout_builder::~layout_builder() = default;
+
+/// Get builder of current thread
+layout_builder &layout_builder::current() noexcept
+{
+	thread_local layout_builder builder;
+	return builder;
+}
+
+/// Get layout of string
+layout layout::of(std::string_view bytes) noexcept
+{
+	return layout_builder::current().build(bytes);
+}
+
+/// Get layout of string, allocating memory from resource
+layout layout::of(
+	std::string_view bytes,
+	std::pmr::memory_resource *resource
+) noexcept
+{
+	return layout_builder::current().build(bytes, resource);
+}
+
+/// Get layout of string, stored with specified strategy
+layout layout::of(
+	std::string_view bytes,
+	layout_strategy strategy
+) noexcept
+{
+	return layout_builder::current().build(
+		bytes, std::pmr::get_default_resource(), strategy
+	);
+}
+
+/// Get layout of string, splitting chunks of string in parallel
+layout layout::of(
+	std::string_view bytes, 
+	const executor &executor,
+	size_t chunk_size
+) noexcept
+{
+	assert(chunk_size != 0 && "chunk size must be positive");
+	if (bytes.size() <= chunk_size || !executor) { return of(bytes); }
+
+	std::vector<std::string_view> chunks;
+	for (size_t start = 0; start < bytes.size();)
+	{
+		auto end = next_independent_boundary(
+			bytes, std::min(start + chunk_size, bytes.size())
+		);
+		chunks.push_back(bytes.substr(start, end - start));
+		start = end;
+	}
+
+	struct chunk_layout
+	{
+		/// Layout of chunk
+		unicode::layout layout;
+		/// Number of characters and bytes inside of chunk
+		layout_progress progress;
+	};
+	std::vector<chunk_layout> results(chunks.size());
+	std::latch done(chunks.size());
+	for (size_t i = 0; i < chunks.size(); ++i)
+	{
+		executor([&, i]
+		{
+			auto &[layout, progress] = results[i];
+			layout_builder::current().extend(
+				layout, chunks[i], progress, chunks[i].size()
+			);
+			done.count_down();
+		});
+	}
+	done.wait();
+
+	// Blocks of chunks are shifted and merged with blocks of same size
+	unicode::layout result(bytes.size());
+	layout_progress total;
+	for (auto &[layout, progress] : results)
+	{
+		for (size_t i = 0; i < layout.size(); ++i)
+		{
+			auto block = layout[i];
+			if (
+				i == 0 && !result.empty() &&
+				result.back().character_size == block.character_size
+			)
+			{
+				continue;
+			}
+			result.push_back(
+				total.characters + layout.offset(i),
+				{
+					.character_size = block.character_size,
+					.byte_offset = total.bytes + block.byte_offset
+				}
+			);
+		}
+		total.characters += progress.characters;
+		total.bytes += progress.bytes;
+	}
+	result.shrink_to_fit();
+	return result;
+}
+
+/// Get layouts of many short strings
+layout_batch layout::of_batch(
+	std::span<const std::string_view> strings
+) noexcept
+{
+	layout_batch batch;
+	size_t total = 0;
+	for (auto bytes : strings) { total += bytes.size(); }
+	// Most short strings fit into inline storage, so arena starts small.
+	// Allocation from arena only moves its pointer
+	batch.arena = std::make_unique<std::pmr::monotonic_buffer_resource>(
+		std::max<size_t>(total / 4, 1024)
+	);
+	batch.layouts.reserve(strings.size());
+
+	auto &builder = layout_builder::current();
+	for (auto bytes : strings)
+	{
+		layout result(bytes.size(), batch.arena.get());
+		// ASCII strings are one block, that is checked by bulk scan
+		if (utf8::ascii_graphemes_prefix(bytes) == bytes.size())
+		{
+			if (!bytes.empty()) { result.push_back(0, {.character_size = 1}); }
+			metrics::add(metrics::counter::bytes_segmented, bytes.size());
+		}
+		else
+		{
+			layout_progress progress;
+			builder.extend(result, bytes, progress, bytes.size());
+		}
+		result.shrink_to_fit();
+		batch.allocated += result.allocated_bytes();
+		batch.layouts.push_back(std::move(result));
 	}
+	return batch;
+}
 
+/// Get layout of string
+layout layout_builder::build(std::string_view bytes) noexcept
+{
+	return build(bytes, std::pmr::get_default_resource());
+}
 
+/// Get layout of string, allocating memory from resource
+layout layout_builder::build(
+	std::string_view bytes,
+	std::pmr::memory_resource *resource,
+	layout_strategy strategy
+) noexcept
+{
+	layout layout(bytes.size(), resource);
+	layout_progress progress;
+	extend(layout, bytes, progress, bytes.size());
+	layout.shrink_to_fit(strategy);
 	return layout;
-}
\ No newline at end of file
+}
+
+/// Extend layout of string, until it covers at least specified number
+/// of bytes
+void layout_builder::extend(
+	layout &layout,
+	std::string_view bytes,
+	layout_progress &progress,
+	size_t byte_count
+) noexcept
+{
+	split(layout, bytes, progress, byte_count, nullptr);
+}
+
+/// Get layout of string, if it's well-formed UTF-8
+size_t layout_builder::build_checked(
+	std::string_view bytes, 
+	layout &layout
+) noexcept
+{
+	layout = unicode::layout(bytes.size());
+	layout_progress progress;
+	size_t ill_formed = SIZE_MAX;
+	split(layout, bytes, progress, bytes.size(), &ill_formed);
+	if (ill_formed != SIZE_MAX)
+	{
+		layout = unicode::layout(bytes.size());
+		return ill_formed;
+	}
+	layout.shrink_to_fit();
+	return SIZE_MAX;
+}
+
+/// Split bytes into characters, until layout covers at least 
+/// specified number of bytes.
+///
+/// Runs of standalone code points, like ASCII, Cyrillic or CJK,
+/// are split into characters without ICU.
+/// ICU is only used for spans with combining marks, joiners, emoji,
+/// regional indicators and other characters with complex rules.
+///
+/// ASCII and standalone runs are well-formed by their classification, 
+/// so only spans for ICU are checked
+void layout_builder::split(
+	layout &layout,
+	std::string_view bytes,
+	layout_progress &progress,
+	size_t byte_count,
+	size_t *ill_formed
+) noexcept
+{
+	assert(progress.bytes <= bytes.size() && "progress is out of range");
+
+	layout_appender appender(layout, progress);
+	
+	// Last standalone code point may join with the next code point,
+	// so it's appended only after next code point is known
+	size_t pending = 0;
+	auto flush = [&]()
+	{
+		if (pending != 0) { appender.append(pending); }
+		pending = 0;
+	};
+
+	size_t position = progress.bytes;
+	while (position < bytes.size())
+	{
+		auto rest = bytes.substr(position);
+
+		if (position >= byte_count)
+		{
+			// Pending code point can't join with CR or standalone code point
+			if (
+				pending == 0 || 
+				rest.front() == '\r' ||
+				standalone_size(rest) != 0
+			)
+			{
+				break;
+			}
+		}
+		auto limit = position < byte_count ? byte_count - position : 0;
+
+		if (utf8::is_ascii_grapheme(rest.front()))
+		{
+			auto ascii = utf8::ascii_graphemes_prefix(rest.substr(0, limit));
+			flush();
+			appender.append(1, ascii - 1);
+			pending = 1;
+			position += ascii;
+			continue;
+		}
+
+		// There are always boundaries before CR and after CR LF
+		if (rest.front() == '\r')
+		{
+			flush();
+			auto size = rest.starts_with("\r\n") ? 2 : 1;
+			appender.append(size);
+			position += size;
+			continue;
+		}
+
+		if (auto run = standalone_run_at(rest, limit); run.count != 0)
+		{
+			flush();
+			appender.append(run.size, run.count - 1);
+			pending = run.size;
+			position += run.size * run.count;
+			continue;
+		}
+
+		// Pending code point may be the start of cluster
+		auto start = position - pending;
+		pending = 0;
+		auto end = complex_span_end(bytes, position, ill_formed);
+		if (ill_formed && *ill_formed != SIZE_MAX) { return; }
+		assert(appender.byte_offset() == start);
+		if (!impl) { impl = std::make_unique<implementation>(); }
+		impl->segment(bytes.substr(start, end - start), appender);
+		position = end;
+	}
+	flush();
+
+	assert(appender.byte_offset() == position);
+	metrics::add(
+		metrics::counter::bytes_segmented, 
+		appender.progress().bytes - progress.bytes
+	);
+	progress = appender.progress();
+}
+
+/// Update layout of string, after bytes of range were replaced
+void layout_builder::update(
+	layout &layout,
+	layout_progress &progress,
+	std::string_view bytes,
+	byte_range changed,
+	size_t new_length
+) noexcept
+{
+	auto old_size = bytes.size() - new_length + changed.size;
+	assert(
+		changed.offset + changed.size <= old_size && 
+		progress.bytes <= old_size &&
+		"change is out of range"
+	);
+
+	if (layout.strategy() == layout_strategy::sampled)
+	{
+		layout.shrink_to_fit(layout_strategy::blocks);
+	}
+
+	auto complete = progress.bytes == old_size;
+	auto old_characters = progress.characters;
+	auto start = restart_point(
+		layout, bytes, std::min(changed.offset, progress.bytes)
+	);
+	if (!complete)
+	{
+		// Lazy layout is extended from restart point on demand
+		layout.truncate(start.characters);
+		progress = start;
+		return;
+	}
+
+	// Blocks after change are moved from old layout
+	auto old = layout;
+	layout.truncate(start.characters);
+	progress = start;
+
+	auto changed_end = changed.offset + new_length;
+	auto byte_count = changed_end;
+	while (progress.bytes < bytes.size())
+	{
+		extend(layout, bytes, progress, byte_count);
+		if (progress.bytes == bytes.size()) { break; }
+
+		// Old and new layouts match after common boundary,
+		// unless regional indicators after it are paired with ones before
+		auto old_byte = progress.bytes - new_length + changed.size;
+		auto [index, offset, block] = old.block_for_byte(old_byte);
+		auto inside = old_byte - block.byte_offset;
+		if (
+			inside % block.character_size != 0 ||
+			regional_indicator_at(bytes, progress.bytes)
+		)
+		{
+			byte_count = progress.bytes + 1;
+			continue;
+		}
+
+		auto old_character = offset + inside / block.character_size;
+		if (
+			layout.empty() || 
+			layout.back().character_size != block.character_size
+		)
+		{
+			layout.push_back(
+				progress.characters, 
+				{
+					.character_size = block.character_size, 
+					.byte_offset = progress.bytes
+				}
+			);
+		}
+		for (auto i = index + 1; i < old.size(); ++i)
+		{
+			auto moved = old[i];
+			layout.push_back(
+				old.offset(i) - old_character + progress.characters,
+				{
+					.character_size = moved.character_size,
+					.byte_offset = moved.byte_offset - old_byte + progress.bytes
+				}
+			);
+		}
+		progress = {
+			.characters = old_characters - old_character + progress.characters,
+			.bytes = bytes.size()
+		};
+		break;
+	}
+}
@@ -0,0 +1,229 @@
+#include "unicode/layout_cache.hpp"
+
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <string>
+
+#include "unicode/metrics.hpp"
+
+#include "utf8/ascii.hpp"
+
+using namespace unicode;
+
+namespace
+{
+
+/// Number of slots, checked for each hash
+constexpr size_t bucket_size = 4;
+
+/// Bits of pointer inside of slot word. 
+/// Other bits count threads, that read entry right now
+constexpr size_t pointer_bits = sizeof(void *) == 8 ? 48 : 32;
+/// One thread, reading entry
+constexpr uint64_t reader = 1ull << pointer_bits;
+/// Mask of pointer bits
+constexpr uint64_t pointer_mask = reader - 1;
+
+/// Does address of entry fit into pointer bits of slot?
+/// Addresses above 48 bits come from 5-level paging, 
+/// and tagged pointers (ARM TBI, MTE, HWASan) use top byte
+bool fits_into_slot(const void *address) noexcept
+{
+	return (reinterpret_cast<uintptr_t>(address) & ~pointer_mask) == 0;
+}
+
+} // namespace
+
+/// Cached layout together with its string
+struct layout_cache::entry
+{
+	/// Hash of string
+	size_t hash = 0;
+	/// Copy of string
+	std::string bytes;
+	/// Layout of string
+	unicode::layout layout;
+	/// Readers, that finished after entry was replaced, 
+	/// minus readers, that were in slot at that moment.
+	/// Entry is freed, when it reaches zero after replacement
+	std::atomic<int64_t> released{0};
+};
+
+/// Reference to entry with counter of threads, that are reading it.
+///
+/// This is split reference counting: readers increment counter
+/// in slot word together with loading pointer, so entry can't be freed
+/// between them. Replacing thread moves that counter to the entry itself
+struct layout_cache::slot
+{
+	/// Pointer to entry and number of its readers
+	std::atomic<uint64_t> word{0};
+	/// Was entry used since the last pass of CLOCK hand?
+	std::atomic<bool> referenced{false};
+
+	/// Get entry of word
+	static entry *entry_of(uint64_t word) noexcept
+	{
+		return reinterpret_cast<entry *>(word & pointer_mask);
+	}
+
+	/// Start reading entry of slot
+	/// @return Null, if slot is empty
+	entry *acquire() noexcept
+	{
+		auto word = this->word.load(std::memory_order_relaxed);
+		do
+		{
+			if (entry_of(word) == nullptr) { return nullptr; }
+		}
+		while (!this->word.compare_exchange_weak(
+			word, word + reader, 
+			std::memory_order_acquire, std::memory_order_relaxed
+		));
+		return entry_of(word);
+	}
+
+	/// Finish reading entry, returned by acquire()
+	void release(entry *e) noexcept
+	{
+		auto word = this->word.load(std::memory_order_relaxed);
+		while (entry_of(word) == e)
+		{
+			if (this->word.compare_exchange_weak(
+				word, word - reader, 
+				std::memory_order_release, std::memory_order_relaxed
+			))
+			{
+				return;
+			}
+		}
+		// Entry was replaced, so counter has moved to it
+		if (e->released.fetch_add(1, std::memory_order_acq_rel) == -1)
+		{
+			delete e;
+		}
+	}
+
+	/// Replace entry of slot. Previous entry is freed by its last reader
+	/// @warning Entry must fit into slot
+	void replace(entry *e) noexcept
+	{
+		assert(fits_into_slot(e) && "pointer doesn't fit into slot");
+		auto previous = word.exchange(
+			reinterpret_cast<uint64_t>(e), std::memory_order_acq_rel
+		);
+		auto *old = entry_of(previous);
+		if (old == nullptr) { return; }
+
+		auto readers = static_cast<int64_t>(previous >> pointer_bits);
+		if (old->released.fetch_sub(readers, std::memory_order_acq_rel) == readers)
+		{
+			delete old;
+		}
+	}
+};
+
+/// Create cache for up to capacity layouts of strings,
+/// that are not longer than max_string_size bytes
+layout_cache::layout_cache(
+	size_t capacity, 
+	size_t max_string_size
+) noexcept
+	: slot_count(std::bit_ceil(std::max(capacity, bucket_size))),
+	  max_size(max_string_size),
+	  slots(new slot[slot_count])
+{}
+
+layout_cache::~layout_cache() { clear(); }
+
+/// Get cache, shared by whole process
+layout_cache &layout_cache::shared() noexcept
+{
+	static layout_cache cache;
+	return cache;
+}
+
+/// Are layouts of string stored in cache?
+bool layout_cache::accepts(std::string_view bytes) const noexcept
+{
+	// ASCII strings are split faster than they are found in cache
+	return 
+		bytes.size() <= max_size && 
+		utf8::ascii_graphemes_prefix(bytes) != bytes.size();
+}
+
+/// Get layout of string
+layout layout_cache::of(std::string_view bytes) noexcept
+{
+	if (!accepts(bytes)) { return layout::of(bytes); }
+
+	auto hash = std::hash<std::string_view>{}(bytes);
+	auto first = hash & (slot_count - 1) & ~(bucket_size - 1);
+	for (size_t i = first; i < first + bucket_size; ++i)
+	{
+		auto &s = slots[i];
+		auto *e = s.acquire();
+		if (e == nullptr) { continue; }
+
+		if (e->hash == hash && e->bytes == bytes)
+		{
+			// Bit is written only when it changes,
+			// so hits on popular strings don't bounce cache line
+			if (!s.referenced.load(std::memory_order_relaxed))
+			{
+				s.referenced.store(true, std::memory_order_relaxed);
+			}
+			unicode::layout result(e->layout);
+			s.release(e);
+			metrics::add(metrics::counter::layout_cache_hits);
+			return result;
+		}
+		s.release(e);
+	}
+
+	metrics::add(metrics::counter::layout_cache_misses);
+	auto *e = new entry{
+		.hash = hash, 
+		.bytes = std::string(bytes), 
+		.layout = layout::of(bytes)
+	};
+	unicode::layout result(e->layout);
+	if (!fits_into_slot(e))
+	{
+		// Layout isn't cached, instead of corrupting counter of readers
+		delete e;
+		return result;
+	}
+
+	// CLOCK hand passes slots of bucket, giving a second chance
+	// to referenced ones. If all of them are referenced, 
+	// the first one is replaced after its bit is cleared
+	auto victim = first;
+	for (size_t i = first; i < first + bucket_size; ++i)
+	{
+		auto &s = slots[i];
+		if (
+			slot::entry_of(s.word.load(std::memory_order_relaxed)) == nullptr ||
+			!s.referenced.exchange(false, std::memory_order_relaxed)
+		)
+		{
+			victim = i;
+			break;
+		}
+	}
+	slots[victim].replace(e);
+	return result;
+}
+
+/// Drop all cached layouts
+void layout_cache::clear() noexcept
+{
+	for (size_t i = 0; i < slot_count; ++i)
+	{
+		slots[i].replace(nullptr);
+		slots[i].referenced.store(false, std::memory_order_relaxed);
+	}
+}
@@ -0,0 +1,437 @@
+#include "unicode/line_reader.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <new>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#ifdef _WIN32
+	#include <fstream>
+#else
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+using namespace unicode;
+
+namespace
+{
+
+/// Alignment of chunks, that matches pages of memory and disk blocks
+constexpr size_t chunk_alignment = 4096;
+
+/// Frees memory of chunk
+struct aligned_delete
+{
+	void operator()(char *data) const noexcept
+	{
+		::operator delete[](data, std::align_val_t(chunk_alignment));
+	}
+};
+
+/// Memory of chunk, aligned to page
+using aligned_buffer = std::unique_ptr<char[], aligned_delete>;
+
+/// Allocate memory of chunk
+aligned_buffer allocate(size_t size)
+{
+	return aligned_buffer(
+		static_cast<char *>(
+			::operator new[](size, std::align_val_t(chunk_alignment))
+		)
+	);
+}
+
+/// File, that is read sequentially
+class file_source
+{
+public:
+	/// Open file for reading
+	explicit file_source(const std::filesystem::path &path) noexcept
+#ifdef _WIN32
+		: file(path, std::ios::binary)
+	{
+		valid = bool(file);
+		if (!valid) { error = std::make_error_code(std::errc::io_error); }
+	}
+#else
+		: descriptor(::open(path.c_str(), O_RDONLY))
+	{
+		valid = descriptor >= 0;
+		if (!valid) { error = std::error_code(errno, std::generic_category()); }
+		if (valid)
+		{
+			// Chunks are read one after another
+			::posix_fadvise(descriptor, 0, 0, POSIX_FADV_SEQUENTIAL);
+		}
+	}
+#endif
+
+	file_source(const file_source &) = delete;
+	file_source &operator=(const file_source &) = delete;
+
+	~file_source()
+	{
+#ifndef _WIN32
+		if (descriptor >= 0) { ::close(descriptor); }
+#endif
+	}
+
+	/// Read bytes, until output is full, file ends or reading fails.
+	/// Failure is kept in error
+	/// @return Number of read bytes
+	size_t read(char *output, size_t size) noexcept
+	{
+#ifdef _WIN32
+		file.read(output, static_cast<std::streamsize>(size));
+		if (file.bad()) { error = std::make_error_code(std::errc::io_error); }
+		return static_cast<size_t>(file.gcount());
+#else
+		size_t total = 0;
+		while (total < size)
+		{
+			auto count = ::read(descriptor, output + total, size - total);
+			if (count < 0 && errno == EINTR) { continue; }
+			if (count < 0) 
+			{ 
+				error = std::error_code(errno, std::generic_category());
+			}
+			if (count <= 0) { break; }
+			total += static_cast<size_t>(count);
+		}
+		return total;
+#endif
+	}
+
+	/// Was file opened successfully?
+	bool valid = false;
+	/// Error of opening or the last reading
+	std::error_code error;
+
+private:
+#ifdef _WIN32
+	/// Stream of file
+	std::ifstream file;
+#else
+	/// Descriptor of file
+	int descriptor = -1;
+#endif
+};
+
+/// Complete lines of file, read at once
+struct chunk
+{
+	/// Index of chunk in file
+	size_t sequence = 0;
+	/// Memory of chunk
+	aligned_buffer memory;
+	/// Size of memory
+	size_t capacity = 0;
+	/// Bytes of lines with their delimiters
+	std::string_view text;
+	/// Lines of chunk, split into characters
+	std::vector<unicode::string_view> lines;
+};
+
+} // namespace
+
+class line_reader::pipeline_state
+{
+public:
+	pipeline_state(const std::filesystem::path &path, options settings)
+		: file(path), settings(settings)
+	{
+		if (this->settings.workers == 0)
+		{
+			auto threads = std::thread::hardware_concurrency();
+			this->settings.workers = std::max(threads, 2u) - 1;
+		}
+		this->settings.chunk_size = std::max<size_t>(1, settings.chunk_size);
+		this->settings.depth = std::max<size_t>(1, settings.depth);
+	}
+
+	pipeline_state(const pipeline_state &) = delete;
+	pipeline_state &operator=(const pipeline_state &) = delete;
+
+	~pipeline_state()
+	{
+		{
+			std::lock_guard lock(mutex);
+			stopped = true;
+		}
+		changed.notify_all();
+		threads.clear();
+	}
+
+	/// Start reading and splitting in background threads
+	void start()
+	{
+		threads.reserve(settings.workers + 1);
+		threads.emplace_back([this] { read_chunks(); });
+		for (size_t i = 0; i < settings.workers; ++i)
+		{
+			threads.emplace_back([this] { split_chunks(); });
+		}
+	}
+
+	/// Get next line of file
+	const unicode::string_view *next()
+	{
+		if (position < current.lines.size())
+		{
+			return &current.lines[position++];
+		}
+
+		std::unique_lock lock(mutex);
+		if (current.memory)
+		{
+			release(std::move(current));
+			current = {};
+		}
+		changed.wait(lock, [&]
+		{
+			return ready.contains(next_sequence) || next_sequence == total;
+		});
+		if (next_sequence == total) { return nullptr; }
+
+		auto found = ready.find(next_sequence++);
+		current = std::move(found->second);
+		ready.erase(found);
+		lock.unlock();
+
+		position = 1;
+		return &current.lines.front();
+	}
+
+	/// Get error, that ended reading before the end of file
+	std::error_code error()
+	{
+		std::lock_guard lock(mutex);
+		return failure;
+	}
+
+	/// File to read
+	file_source file;
+
+private:
+	/// Options of reading
+	options settings;
+
+	/// Guards chunks, that are shared between threads
+	std::mutex mutex;
+	/// Notifies about added, split and released chunks
+	std::condition_variable changed;
+	/// Chunks, that are read, but not split into lines yet
+	std::deque<chunk> read;
+	/// Split chunks by their sequence, waiting for consumer
+	std::map<size_t, chunk> ready;
+	/// Released chunks, which memory is reused
+	std::vector<chunk> released;
+	/// Number of read chunks, that aren't released by consumer
+	size_t in_flight = 0;
+	/// Number of chunks in file, known after the end of file
+	size_t total = SIZE_MAX;
+	/// Error, that ended reading before the end of file
+	std::error_code failure;
+	/// Are background threads stopped?
+	bool stopped = false;
+
+	/// Chunk, which lines are consumed
+	chunk current;
+	/// Index of the next line of current chunk
+	size_t position = 0;
+	/// Sequence of the next chunk to consume
+	size_t next_sequence = 0;
+
+	/// Reading and splitting threads, that are joined first on destruction
+	std::vector<std::jthread> threads;
+
+	/// Return chunk to be reused for reading
+	/// @warning Mutex must be locked
+	void release(chunk &&finished)
+	{
+		finished.lines.clear();
+		finished.text = {};
+		released.push_back(std::move(finished));
+		--in_flight;
+		changed.notify_all();
+	}
+
+	/// Get empty chunk with at least capacity bytes of memory
+	/// @warning Mutex must be locked
+	chunk take(size_t capacity)
+	{
+		chunk result;
+		if (!released.empty())
+		{
+			result = std::move(released.back());
+			released.pop_back();
+		}
+		if (result.capacity < capacity)
+		{
+			result.capacity =
+				(capacity + chunk_alignment - 1) / chunk_alignment *
+				chunk_alignment;
+			result.memory = allocate(result.capacity);
+		}
+		return result;
+	}
+
+	/// Grow memory of chunk, keeping its first size bytes
+	static void grow(chunk &target, size_t size, size_t capacity)
+	{
+		auto memory = allocate(capacity);
+		std::memcpy(memory.get(), target.memory.get(), size);
+		target.memory = std::move(memory);
+		target.capacity = capacity;
+	}
+
+	/// Read file by chunks, that end after delimiter
+	void read_chunks()
+	{
+		// Part of the last line, that is continued in the next chunk
+		std::string carry;
+		for (size_t sequence = 0;;)
+		{
+			chunk next;
+			{
+				std::unique_lock lock(mutex);
+				changed.wait(lock, [&]
+				{
+					return in_flight < settings.depth || stopped;
+				});
+				if (stopped) { return; }
+				next = take(carry.size() + settings.chunk_size);
+				++in_flight;
+			}
+
+			std::memcpy(next.memory.get(), carry.data(), carry.size());
+			auto [size, end, finished] = fill(next, carry.size());
+			next.sequence = sequence;
+			next.text = std::string_view(next.memory.get(), end);
+			carry.assign(next.memory.get() + end, size - end);
+
+			std::lock_guard lock(mutex);
+			if (next.text.empty())
+			{
+				release(std::move(next));
+			}
+			else
+			{
+				read.push_back(std::move(next));
+				++sequence;
+			}
+			if (finished) 
+			{ 
+				total = sequence; 
+				failure = file.error;
+			}
+			changed.notify_all();
+			if (finished) { return; }
+		}
+	}
+
+	/// Read bytes after the first size bytes of chunk,
+	/// until they have delimiter or file ends
+	/// @return Size of read bytes, size of complete lines and end of file
+	std::tuple<size_t, size_t, bool> fill(chunk &target, size_t size)
+	{
+		for (auto searched = size;;)
+		{
+			if (size + settings.chunk_size > target.capacity)
+			{
+				grow(target, size, 2 * (size + settings.chunk_size));
+			}
+			auto count = file.read(
+				target.memory.get() + size, settings.chunk_size
+			);
+			size += count;
+			if (count < settings.chunk_size) { return {size, size, true}; }
+
+			// Chunk ends after the last delimiter of file
+			std::string_view added(
+				target.memory.get() + searched, size - searched
+			);
+			auto last = added.rfind(settings.delimiter);
+			if (last != std::string_view::npos)
+			{
+				return {size, searched + last + 1, false};
+			}
+			searched = size;
+		}
+	}
+
+	/// Split read chunks into lines
+	void split_chunks()
+	{
+		std::unique_lock lock(mutex);
+		while (true)
+		{
+			changed.wait(lock, [&]
+			{
+				return !read.empty() || stopped || total != SIZE_MAX;
+			});
+			if (stopped || read.empty()) { return; }
+
+			auto target = std::move(read.front());
+			read.pop_front();
+			lock.unlock();
+
+			split(target);
+
+			lock.lock();
+			ready.emplace(target.sequence, std::move(target));
+			changed.notify_all();
+		}
+	}
+
+	/// Split text of chunk into lines without delimiters
+	void split(chunk &target) const
+	{
+		auto text = target.text;
+		while (!text.empty())
+		{
+			auto end = std::min(text.find(settings.delimiter), text.size());
+			target.lines.emplace_back(text.substr(0, end));
+			text.remove_prefix(std::min(end + 1, text.size()));
+		}
+	}
+};
+
+line_reader::line_reader(const std::filesystem::path &path)
+	: line_reader(path, options{}) {}
+
+line_reader::line_reader(const std::filesystem::path &path, options settings)
+	: pipeline(std::make_unique<pipeline_state>(path, settings))
+{
+	if (!pipeline->file.valid)
+	{
+		open_error = pipeline->file.error;
+		pipeline.reset();
+		return;
+	}
+	pipeline->start();
+}
+
+line_reader::line_reader(line_reader &&other) noexcept = default;
+line_reader &line_reader::operator=(line_reader &&other) noexcept = default;
+line_reader::~line_reader() = default;
+
+const unicode::string_view *line_reader::next()
+{
+	return pipeline ? pipeline->next() : nullptr;
+}
+
+std::error_code line_reader::error() const
+{
+	return pipeline ? pipeline->error() : open_error;
+}
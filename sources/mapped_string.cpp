@@ -0,0 +1,295 @@
+#include "unicode/mapped_string.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <span>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+	#include <iterator>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+using namespace unicode;
+
+namespace
+{
+
+/// Read-only memory of file
+class file_mapping
+{
+public:
+	/// Map file to memory
+	explicit file_mapping(const std::filesystem::path &path) noexcept
+	{
+#ifdef _WIN32
+		// Fallback to reading whole file
+		std::ifstream file(path, std::ios::binary);
+		if (!file) { return; }
+		content.assign(
+			std::istreambuf_iterator<char>(file), 
+			std::istreambuf_iterator<char>()
+		);
+		valid = !file.bad();
+#else
+		auto descriptor = ::open(path.c_str(), O_RDONLY);
+		if (descriptor < 0) { return; }
+
+		struct stat status;
+		if (::fstat(descriptor, &status) == 0)
+		{
+			size = static_cast<size_t>(status.st_size);
+			if (size == 0) 
+			{ 
+				valid = true; 
+			}
+			else if (
+				auto *address = ::mmap(
+					nullptr, size, PROT_READ, MAP_PRIVATE, descriptor, 0
+				);
+				address != MAP_FAILED
+			)
+			{
+				data = static_cast<const char *>(address);
+				valid = true;
+			}
+		}
+		::close(descriptor);
+#endif
+	}
+
+	file_mapping(const file_mapping &) = delete;
+	file_mapping &operator=(const file_mapping &) = delete;
+
+	~file_mapping()
+	{
+#ifndef _WIN32
+		if (data) { ::munmap(const_cast<char *>(data), size); }
+#endif
+	}
+
+	/// Get bytes of file
+	std::string_view bytes() const noexcept
+	{
+#ifdef _WIN32
+		return content;
+#else
+		return {data, size};
+#endif
+	}
+
+	/// Was file mapped successfully?
+	bool valid = false;
+
+private:
+#ifdef _WIN32
+	/// Content of file
+	std::string content;
+#else
+	/// Address of mapped memory
+	const char *data = nullptr;
+	/// Size of file
+	size_t size = 0;
+#endif
+};
+
+/// Header of sidecar file with layout
+struct sidecar_header
+{
+	/// Signature of sidecar file
+	static constexpr char signature[8] = "ULAYOUT";
+	/// Current version of format
+	static constexpr uint32_t current_version = 1;
+	/// Value, that is read differently on machines with other byte order
+	static constexpr uint32_t native_byte_order = 0x01020304;
+
+	/// Signature of file
+	char magic[8] = {};
+	/// Version of format
+	uint32_t version = 0;
+	/// Byte order of integers
+	uint32_t byte_order = 0;
+	/// Size of string file in bytes
+	uint64_t string_size = 0;
+	/// Checksum of string file
+	uint64_t string_checksum = 0;
+	/// Number of blocks
+	uint64_t block_count = 0;
+	/// Size of integers in bytes
+	uint64_t integer_width = 0;
+	/// Checksum of serialized blocks
+	uint64_t layout_checksum = 0;
+};
+
+/// Get checksum of bytes. Reads 8 bytes at once to keep up with memory
+uint64_t checksum(std::span<const std::byte> bytes) noexcept
+{
+	constexpr uint64_t multiplier = 0x9E3779B97F4A7C15;
+
+	uint64_t hash = bytes.size() * multiplier;
+	auto mix = [&](uint64_t word)
+	{
+		hash = (hash ^ word) * multiplier;
+		hash ^= hash >> 29;
+	};
+
+	size_t i = 0;
+	for (; i + 8 <= bytes.size(); i += 8)
+	{
+		uint64_t word;
+		std::memcpy(&word, bytes.data() + i, sizeof(word));
+		mix(word);
+	}
+	if (i < bytes.size())
+	{
+		uint64_t word = 0;
+		std::memcpy(&word, bytes.data() + i, bytes.size() - i);
+		mix(word);
+	}
+	return hash;
+}
+
+/// Get checksum of string
+uint64_t checksum(std::string_view bytes) noexcept
+{
+	return checksum(std::as_bytes(std::span(bytes)));
+}
+
+/// Load layout of string from sidecar file
+/// @return false, if sidecar is missing or stale
+bool load_layout(
+	const std::filesystem::path &sidecar, 
+	std::string_view bytes,
+	layout &result
+) noexcept
+{
+	file_mapping file(sidecar);
+	auto content = std::as_bytes(std::span(file.bytes()));
+	if (!file.valid || content.size() < sizeof(sidecar_header)) 
+	{ 
+		return false; 
+	}
+
+	sidecar_header header;
+	std::memcpy(&header, content.data(), sizeof(header));
+	auto blocks = content.subspan(sizeof(header));
+	if (
+		std::memcmp(header.magic, header.signature, sizeof(header.magic)) ||
+		header.version != header.current_version ||
+		header.byte_order != header.native_byte_order ||
+		header.string_size != bytes.size() ||
+		header.layout_checksum != checksum(blocks) ||
+		header.string_checksum != checksum(bytes)
+	)
+	{
+		return false;
+	}
+
+	auto loaded = layout::deserialize(
+		blocks, header.block_count, header.integer_width
+	);
+	if (loaded.empty() != bytes.empty()) { return false; }
+
+	if (!loaded.empty())
+	{
+		auto last = loaded.back();
+		if (last.character_size == 0 || last.byte_offset >= bytes.size())
+		{
+			return false;
+		}
+	}
+	result = std::move(loaded);
+	return true;
+}
+
+} // namespace
+
+/// Read-only memory of string file
+class mapped_string::mapping : public file_mapping
+{
+	using file_mapping::file_mapping;
+};
+
+/// Map file to memory
+mapped_string::mapped_string(const std::filesystem::path &path) noexcept
+	: file_path(path), memory(std::make_unique<mapping>(path))
+{
+	if (!memory->valid) { return; }
+	mapped = true;
+
+	auto bytes = memory->bytes();
+	layout loaded;
+	layout_loaded = load_layout(sidecar_path(path), bytes, loaded);
+	string = layout_loaded ?
+		unicode::string_view(bytes, std::move(loaded)) :
+		unicode::string_view(bytes);
+}
+
+mapped_string::mapped_string(mapped_string &&other) noexcept = default;
+mapped_string &mapped_string::operator=(mapped_string &&other) noexcept 
+	= default;
+mapped_string::~mapped_string() = default;
+
+/// Get path of sidecar file with layout of string file
+std::filesystem::path mapped_string::sidecar_path(
+	const std::filesystem::path &path
+)
+{
+	auto sidecar = path;
+	sidecar += ".layout";
+	return sidecar;
+}
+
+/// Save layout to sidecar file
+bool mapped_string::save_layout() const noexcept
+{
+	if (!mapped) { return false; }
+
+	// Sidecar stores blocks, sampling is repeated on load
+	auto layout = string.blocks();
+	if (layout.strategy() == layout_strategy::sampled)
+	{
+		layout.shrink_to_fit(layout_strategy::blocks);
+	}
+	std::vector<std::byte> blocks(layout.serialized_size());
+	layout.serialize(blocks.data());
+
+	sidecar_header header;
+	std::memcpy(header.magic, header.signature, sizeof(header.magic));
+	header.version = header.current_version;
+	header.byte_order = header.native_byte_order;
+	header.string_size = bytes().size();
+	header.string_checksum = checksum(bytes());
+	header.block_count = layout.size();
+	header.integer_width = layout.integer_width();
+	header.layout_checksum = checksum(blocks);
+
+	// Sidecar is replaced at once, so readers never see partial file
+	auto sidecar = sidecar_path(file_path);
+	auto temporary = sidecar;
+	temporary += ".tmp";
+	{
+		std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+		file.write(
+			reinterpret_cast<const char *>(blocks.data()), blocks.size()
+		);
+		if (!file.flush()) { return false; }
+	}
+
+	std::error_code error;
+	std::filesystem::rename(temporary, sidecar, error);
+	if (error)
+	{
+		std::filesystem::remove(temporary, error);
+		return false;
+	}
+	return true;
+}
@@ -0,0 +1,123 @@
+#include "unicode/metrics.hpp"
+
+#include <mutex>
+#include <vector>
+
+using namespace unicode;
+using namespace unicode::metrics;
+
+namespace
+{
+
+#if defined(UNICODE_METRICS)
+
+/// Counters of all threads
+struct registry
+{
+	/// Protects all fields
+	std::mutex mutex;
+	/// Counters of running threads
+	std::vector<const thread_counters *> threads;
+	/// Counters of finished threads
+	counters finished;
+	/// Counters at the moment of last reset
+	counters baseline;
+
+	/// Get counters of all threads, without baseline
+	counters total() const noexcept
+	{
+		auto result = finished;
+		for (auto *thread : threads)
+		{
+			auto load = [](auto &from, auto &to)
+			{
+				for (size_t i = 0; i < from.size(); ++i)
+				{
+					to[i] += from[i].load(std::memory_order_relaxed);
+				}
+			};
+			load(thread->values, result.values);
+			load(thread->blocks_per_layout, result.blocks_per_layout);
+		}
+		return result;
+	}
+};
+
+/// Get registry of counters. 
+/// Never destroyed, because threads may finish after static destructors
+registry &counters_registry() noexcept
+{
+	static auto *instance = new registry;
+	return *instance;
+}
+
+#endif
+
+} // namespace
+
+#if defined(UNICODE_METRICS)
+
+/// Register counters of thread
+thread_counters::thread_counters() noexcept
+{
+	auto &r = counters_registry();
+	std::scoped_lock lock(r.mutex);
+	r.threads.push_back(this);
+}
+
+/// Move counters of finished thread to shared total
+thread_counters::~thread_counters()
+{
+	auto &r = counters_registry();
+	std::scoped_lock lock(r.mutex);
+	for (size_t i = 0; i < values.size(); ++i)
+	{
+		r.finished.values[i] += values[i].load(std::memory_order_relaxed);
+	}
+	for (size_t i = 0; i < blocks_per_layout.size(); ++i)
+	{
+		r.finished.blocks_per_layout[i] += 
+			blocks_per_layout[i].load(std::memory_order_relaxed);
+	}
+	std::erase(r.threads, this);
+}
+
+/// Get counters of current thread
+thread_counters &unicode::metrics::local() noexcept
+{
+	thread_local thread_counters counters;
+	return counters;
+}
+
+#endif
+
+/// Get counters, summed over all threads, since the last reset()
+counters unicode::metrics::snapshot() noexcept
+{
+#if defined(UNICODE_METRICS)
+	auto &r = counters_registry();
+	std::scoped_lock lock(r.mutex);
+	auto result = r.total();
+	for (size_t i = 0; i < result.values.size(); ++i)
+	{
+		result.values[i] -= r.baseline.values[i];
+	}
+	for (size_t i = 0; i < result.blocks_per_layout.size(); ++i)
+	{
+		result.blocks_per_layout[i] -= r.baseline.blocks_per_layout[i];
+	}
+	return result;
+#else
+	return {};
+#endif
+}
+
+/// Start counting from zero
+void unicode::metrics::reset() noexcept
+{
+#if defined(UNICODE_METRICS)
+	auto &r = counters_registry();
+	std::scoped_lock lock(r.mutex);
+	r.baseline = r.total();
+#endif
+}
@@ -0,0 +1,187 @@
+#include "unicode/sort_key.hpp"
+
+#include <algorithm>
+#include <array>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+using namespace unicode;
+
+/// Get sort key of UTF-8 string
+sort_key::sort_key(std::string_view string, const collator &coll) noexcept
+{
+	std::array<uint8_t, 256> local;
+	auto size = coll.write_sort_key(string, local.data(), local.size());
+	if (size == 0) { return; }
+
+	buffer.reset(new uint8_t[size]);
+	if (size <= local.size())
+	{
+		std::copy_n(local.data(), size, buffer.get());
+	}
+	else
+	{
+		[[maybe_unused]]
+		auto written = coll.write_sort_key(string, buffer.get(), size);
+		assert(written == size && "sort key changed its size");
+	}
+	// Terminating zero isn't needed for memcmp comparison
+	length = size - 1;
+}
+
+/// Add sort key of UTF-8 string to the end of arena
+void sort_keys::push_back(
+	std::string_view string,
+	const collator &coll
+) noexcept
+{
+	auto begin = arena.size();
+	// Sort keys are usually a bit longer than their strings
+	arena.resize(begin + 2 * string.size() + 16);
+
+	auto size = coll.write_sort_key(
+		string, arena.data() + begin, arena.size() - begin
+	);
+	if (begin + size > arena.size())
+	{
+		arena.resize(begin + size);
+		[[maybe_unused]]
+		auto written = coll.write_sort_key(
+			string, arena.data() + begin, size
+		);
+		assert(written == size && "sort key changed its size");
+	}
+
+	// Terminating zero isn't needed for memcmp comparison
+	arena.resize(size == 0 ? begin : begin + size - 1);
+	ends.push_back(arena.size());
+}
+
+namespace
+{
+
+/// Position of string together with first bytes of its sort key
+struct keyed_index
+{
+	/// First 8 bytes of sort key, as big endian number
+	uint64_t prefix = 0;
+	/// Index of string
+	size_t index = 0;
+};
+
+/// Get first 8 bytes of key as big endian number.
+/// Sort keys have no zero bytes, so shorter keys get smaller prefixes
+uint64_t prefix_of(sort_key_view key) noexcept
+{
+	uint64_t prefix = 0;
+	auto bytes = key.bytes();
+	for (size_t i = 0; i < sizeof(prefix); ++i)
+	{
+		prefix = prefix << 8 | (i < bytes.size() ? bytes[i] : 0);
+	}
+	return prefix;
+}
+
+/// Run function for each chunk on its own thread
+template<typename Function>
+void for_each_chunk(size_t chunks, Function &&function)
+{
+	if (chunks == 1) { return function(0); }
+
+	std::vector<std::jthread> threads;
+	threads.reserve(chunks - 1);
+	for (size_t chunk = 1; chunk < chunks; ++chunk)
+	{
+		threads.emplace_back(function, chunk);
+	}
+	function(0);
+}
+
+} // namespace
+
+/// Get indices of strings in order of their sort keys
+std::vector<size_t> unicode::collation_order(
+	std::span<const std::string_view> strings,
+	std::string_view locale,
+	collation_strength strength,
+	bool parallel
+) noexcept
+{
+	// Threads are started only for big enough ranges, 
+	// because each of them creates its own collator
+	constexpr size_t min_chunk_size = 16 * 1024;
+	size_t chunks = 1;
+	if (parallel)
+	{
+		chunks = std::clamp<size_t>(
+			strings.size() / min_chunk_size, 1, 
+			std::max(1u, std::thread::hardware_concurrency())
+		);
+	}
+	auto chunk_size = (strings.size() + chunks - 1) / std::max<size_t>(chunks, 1);
+
+	std::vector<sort_keys> keys(chunks);
+	std::vector<sort_key_view> key_of(strings.size());
+	std::vector<keyed_index> order(strings.size());
+	auto less = [&](const keyed_index &lhs, const keyed_index &rhs)
+	{
+		if (lhs.prefix != rhs.prefix) { return lhs.prefix < rhs.prefix; }
+		return key_of[lhs.index] < key_of[rhs.index];
+	};
+
+	// Each chunk is keyed and sorted by its own thread
+	auto bounds = [&](size_t chunk)
+	{
+		auto begin = std::min(chunk * chunk_size, strings.size());
+		return std::pair(begin, std::min(begin + chunk_size, strings.size()));
+	};
+	for_each_chunk(chunks, [&](size_t chunk)
+	{
+		auto &coll = collator::cached(locale, strength);
+		auto [begin, end] = bounds(chunk);
+
+		// Byte-identical strings share one key
+		std::unordered_map<std::string_view, size_t> unique;
+		std::vector<size_t> key_index(end - begin);
+		for (auto i = begin; i < end; ++i)
+		{
+			auto [it, inserted] = unique.try_emplace(
+				strings[i], keys[chunk].size()
+			);
+			if (inserted) { keys[chunk].push_back(strings[i], coll); }
+			key_index[i - begin] = it->second;
+		}
+
+		for (auto i = begin; i < end; ++i)
+		{
+			key_of[i] = keys[chunk][key_index[i - begin]];
+			order[i] = {.prefix = prefix_of(key_of[i]), .index = i};
+		}
+		std::sort(order.begin() + begin, order.begin() + end, less);
+	});
+
+	// Sorted chunks are merged pairwise
+	for (size_t width = 1; width < chunks; width *= 2)
+	{
+		for_each_chunk((chunks + 2 * width - 1) / (2 * width), [&](size_t pair)
+		{
+			auto first = bounds(2 * pair * width).first;
+			auto middle = bounds(std::min((2 * pair + 1) * width, chunks)).first;
+			auto last = bounds(std::min((2 * pair + 2) * width, chunks)).first;
+			std::inplace_merge(
+				order.begin() + first, 
+				order.begin() + middle, 
+				order.begin() + last, 
+				less
+			);
+		});
+	}
+
+	std::vector<size_t> indices(order.size());
+	std::ranges::transform(
+		order, indices.begin(), 
+		[](auto &entry) { return entry.index; }
+	);
+	return indices;
+}
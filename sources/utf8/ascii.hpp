@@ -0,0 +1,190 @@
+#pragma once
+
+#include <bit>
+#include <cstdint>
+#include <string_view>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define UNICODE_ASCII_SSE2 1
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define UNICODE_ASCII_NEON 1
+#endif
+
+#if defined(__aarch64__) || defined(_M_ARM64)
+#define UNICODE_ASCII_NEON_ACROSS 1
+#endif
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <immintrin.h>
+#define UNICODE_ASCII_AVX2 1
+#endif
+
+namespace unicode::utf8
+{
+
+#if defined(UNICODE_ASCII_NEON)
+/// Get minimal byte of vector.
+/// Only AArch64 reduces across lanes, so armv7 reduces pairwise
+inline uint8_t min_lane(uint8x16_t vector) noexcept
+{
+#if defined(UNICODE_ASCII_NEON_ACROSS)
+	return vminvq_u8(vector);
+#else
+	auto half = vpmin_u8(vget_low_u8(vector), vget_high_u8(vector));
+	half = vpmin_u8(half, half);
+	half = vpmin_u8(half, half);
+	half = vpmin_u8(half, half);
+	return vget_lane_u8(half, 0);
+#endif
+}
+
+/// Get maximal byte of vector
+inline uint8_t max_lane(uint8x16_t vector) noexcept
+{
+#if defined(UNICODE_ASCII_NEON_ACROSS)
+	return vmaxvq_u8(vector);
+#else
+	auto half = vpmax_u8(vget_low_u8(vector), vget_high_u8(vector));
+	half = vpmax_u8(half, half);
+	half = vpmax_u8(half, half);
+	half = vpmax_u8(half, half);
+	return vget_lane_u8(half, 0);
+#endif
+}
+#endif
+
+/// Is byte a printable ASCII character?
+constexpr bool is_printable_ascii(char byte) noexcept
+{
+	return 0x20 <= byte && byte <= 0x7E;
+}
+
+/// Get length of the longest prefix of printable ASCII characters
+inline size_t printable_ascii_prefix(std::string_view bytes) noexcept
+{
+	size_t i = 0;
+#if defined(UNICODE_ASCII_SSE2)
+	const __m128i low = _mm_set1_epi8(0x1F);
+	const __m128i high = _mm_set1_epi8(0x7F);
+	for (; i + 16 <= bytes.size(); i += 16)
+	{
+		auto chunk = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(bytes.data() + i)
+		);
+		// Bytes above 0x7F are negative, so they fail first comparison
+		auto printable = _mm_and_si128(
+			_mm_cmpgt_epi8(chunk, low), _mm_cmplt_epi8(chunk, high)
+		);
+		auto mask = _mm_movemask_epi8(printable);
+		if (mask != 0xFFFF)
+		{
+			return i + std::countr_zero(~unsigned(mask));
+		}
+	}
+#elif defined(UNICODE_ASCII_NEON)
+	for (; i + 16 <= bytes.size(); i += 16)
+	{
+		auto chunk = vld1q_u8(
+			reinterpret_cast<const uint8_t *>(bytes.data() + i)
+		);
+		auto printable = vandq_u8(
+			vcgeq_u8(chunk, vdupq_n_u8(0x20)), 
+			vcleq_u8(chunk, vdupq_n_u8(0x7E))
+		);
+		if (min_lane(printable) != 0xFF) { break; }
+	}
+#endif
+	for (; i < bytes.size(); ++i)
+	{
+		if (!is_printable_ascii(bytes[i])) { return i; }
+	}
+	return i;
+}
+
+/// Does string consist of printable ASCII characters only?
+inline bool is_printable_ascii(std::string_view bytes) noexcept
+{
+	return printable_ascii_prefix(bytes) == bytes.size();
+}
+
+/// Is byte an ASCII character, that is a grapheme cluster on its own,
+/// when followed by ASCII? That's everything, except carriage return
+constexpr bool is_ascii_grapheme(char byte) noexcept
+{
+	return static_cast<uint8_t>(byte) < 0x80 && byte != '\r';
+}
+
+#if defined(UNICODE_ASCII_AVX2)
+/// Get length of the prefix of ASCII graphemes, processed by 32 bytes
+__attribute__((target("avx2")))
+inline size_t ascii_graphemes_prefix_avx2(std::string_view bytes) noexcept
+{
+	const __m256i cr = _mm256_set1_epi8('\r');
+
+	size_t i = 0;
+	for (; i + 32 <= bytes.size(); i += 32)
+	{
+		auto chunk = _mm256_loadu_si256(
+			reinterpret_cast<const __m256i *>(bytes.data() + i)
+		);
+		auto mask = unsigned(_mm256_movemask_epi8(chunk)) | 
+			unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, cr)));
+		if (mask != 0) { return i + std::countr_zero(mask); }
+	}
+	return i;
+}
+
+/// Does CPU support AVX2?
+inline bool has_avx2() noexcept
+{
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+#endif
+
+/// Get length of the longest prefix of ASCII graphemes.
+/// Uses AVX2, SSE2 or NEON, when available
+inline size_t ascii_graphemes_prefix(std::string_view bytes) noexcept
+{
+	size_t i = 0;
+#if defined(UNICODE_ASCII_AVX2)
+	if (bytes.size() >= 32 && has_avx2())
+	{
+		i = ascii_graphemes_prefix_avx2(bytes);
+		if (i + 32 <= bytes.size()) { return i; }
+	}
+#endif
+#if defined(UNICODE_ASCII_SSE2)
+	const __m128i cr = _mm_set1_epi8('\r');
+	for (; i + 16 <= bytes.size(); i += 16)
+	{
+		auto chunk = _mm_loadu_si128(
+			reinterpret_cast<const __m128i *>(bytes.data() + i)
+		);
+		auto mask = unsigned(_mm_movemask_epi8(chunk)) | 
+			unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(chunk, cr)));
+		if (mask != 0) { return i + std::countr_zero(mask); }
+	}
+#elif defined(UNICODE_ASCII_NEON)
+	for (; i + 16 <= bytes.size(); i += 16)
+	{
+		auto chunk = vld1q_u8(
+			reinterpret_cast<const uint8_t *>(bytes.data() + i)
+		);
+		auto special = vorrq_u8(
+			vcgeq_u8(chunk, vdupq_n_u8(0x80)), 
+			vceqq_u8(chunk, vdupq_n_u8('\r'))
+		);
+		if (max_lane(special) != 0) { break; }
+	}
+#endif
+	for (; i < bytes.size(); ++i)
+	{
+		if (!is_ascii_grapheme(bytes[i])) { return i; }
+	}
+	return i;
+}
+
+} // namespace unicode::utf8
@@ -1,9 +1,6 @@
 #include "unicode/utf8/compare.hpp"
 
-#include <cassert>
-#include <memory> // std::unique_ptr
-
-#include <unicode/coll.h>
+#include "unicode/collator.hpp"
 
 /// Compare two UTF-8 strings with default locale comparison rules
 std::strong_ordering unicode::utf8::compare(
@@ -11,28 +8,35 @@ std::strong_ordering unicode::utf8::compare(
 	std::string_view rhs
 ) noexcept
 {
-	UErrorCode errorCode = U_ZERO_ERROR;
-	std::unique_ptr<icu::Collator> coll{
-		icu::Collator::createInstance(
-			icu::Locale::getDefault(), 
-			errorCode
-		)
-	};
-	if (U_FAILURE(errorCode)) 
-	{
-		assert(false && "coudn't create collator"); 
-		/// Fallback to byte comparison
-		return lhs.compare(rhs) <=> 0; 
-	}
+	return collator::cached().compare(lhs, rhs);
+}
+
+/// Compare two UTF-8 strings with rules of specific collator
+std::strong_ordering unicode::utf8::compare(
+	std::string_view lhs, 
+	std::string_view rhs,
+	const collator &coll
+) noexcept
+{
+	return coll.compare(lhs, rhs);
+}
 
-	errorCode = U_ZERO_ERROR;
-	auto res = coll->compareUTF8(lhs, rhs, errorCode);
-	if (U_FAILURE(errorCode))
-	{
-		assert(false && "collator error");
-		/// Fallback to byte comparison
-		return lhs.compare(rhs) <=> 0; 
-	}
+/// Check that two UTF-8 strings are equal with default locale rules
+bool unicode::utf8::equal(
+	std::string_view lhs, 
+	std::string_view rhs
+) noexcept
+{
+	if (lhs == rhs) { return true; }
+	return collator::cached().equal(lhs, rhs);
+}
 
-	return res <=> 0;
+/// Check that two UTF-8 strings are equal with rules of specific collator
+bool unicode::utf8::equal(
+	std::string_view lhs, 
+	std::string_view rhs,
+	const collator &coll
+) noexcept
+{
+	return coll.equal(lhs, rhs);
 }
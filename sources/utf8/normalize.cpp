@@ -0,0 +1,161 @@
+#include "unicode/utf8/normalize.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <functional>
+#include <utility>
+
+#include "unicode/metrics.hpp"
+#include "unicode/utf8/grapheme.hpp"
+
+#include <unicode/bytestream.h>
+#include <unicode/normalizer2.h>
+
+namespace
+{
+
+/// Ranges of frequent code points, that have canonical combining class 0 
+/// and never compose with adjacent code points.
+/// Any string of them is in NFC.
+/// Other code points of such ranges, 
+/// like CJK compatibility ideographs, aren't included
+constexpr std::array<std::pair<char32_t, char32_t>, 7> stable_ranges = {{
+	{0x0000, 0x02FF}, // Latin, IPA, Spacing Modifiers
+	{0x0400, 0x0482}, // Cyrillic
+	{0x3000, 0x3029}, // CJK Symbols and Punctuation
+	{0x3041, 0x3096}, // Hiragana, except combining sound marks
+	{0x30A1, 0x30FA}, // Katakana
+	{0x4E00, 0x9FFF}, // CJK Unified Ideographs
+	{0xAC00, 0xD7A3}, // Hangul Syllables
+}};
+
+/// Is string in NFC, because all its code points are stable?
+bool is_stable(std::string_view bytes) noexcept
+{
+	for (size_t i = 0; i < bytes.size();)
+	{
+		// Combining marks start at U+0300, encoded as 0xCC 0x80
+		if (static_cast<uint8_t>(bytes[i]) < 0xCC) { ++i; continue; }
+
+		auto codepoint = unicode::utf8::decode(bytes.substr(i));
+		if (
+			codepoint.size == 0 || 
+			std::ranges::none_of(stable_ranges, [&](auto &range)
+			{
+				return 
+					range.first <= codepoint.value && 
+					codepoint.value <= range.second;
+			})
+		)
+		{
+			return false;
+		}
+		i += codepoint.size;
+	}
+	return true;
+}
+
+/// Get NFC normalizer
+const icu::Normalizer2 *nfc() noexcept
+{
+	static const icu::Normalizer2 *normalizer = []
+	{
+		UErrorCode errorCode = U_ZERO_ERROR;
+		auto *normalizer = icu::Normalizer2::getNFCInstance(errorCode);
+		assert(U_SUCCESS(errorCode) && "couldn't get NFC normalizer");
+		return U_SUCCESS(errorCode) ? normalizer : nullptr;
+	}();
+	return normalizer;
+}
+
+/// Write NFC form of string to buffer
+void normalize_to(std::string_view bytes, std::string &buffer) noexcept
+{
+	buffer.clear();
+	auto *normalizer = nfc();
+	if (!normalizer)
+	{
+		/// Fallback to bytes themselves
+		buffer = bytes;
+		return;
+	}
+
+	unicode::metrics::add(unicode::metrics::counter::normalizations_icu);
+	unicode::metrics::icu_timer timer;
+	UErrorCode errorCode = U_ZERO_ERROR;
+	icu::StringByteSink<std::string> sink(&buffer, bytes.size());
+	normalizer->normalizeUTF8(
+		0, 
+		icu::StringPiece(bytes.data(), static_cast<int32_t>(bytes.size())), 
+		sink, 
+		nullptr, 
+		errorCode
+	);
+	if (U_FAILURE(errorCode))
+	{
+		assert(false && "couldn't normalize string");
+		buffer = bytes;
+	}
+}
+
+} // namespace
+
+/// Is UTF-8 string in Normalization Form C?
+bool unicode::utf8::is_nfc(std::string_view bytes) noexcept
+{
+	if (is_stable(bytes)) 
+	{
+		unicode::metrics::add(unicode::metrics::counter::normalizations_fast);
+		return true; 
+	}
+
+	auto *normalizer = nfc();
+	if (!normalizer) { return false; }
+
+	unicode::metrics::add(unicode::metrics::counter::normalizations_icu);
+	unicode::metrics::icu_timer timer;
+	UErrorCode errorCode = U_ZERO_ERROR;
+	auto normalized = normalizer->isNormalizedUTF8(
+		icu::StringPiece(bytes.data(), static_cast<int32_t>(bytes.size())),
+		errorCode
+	);
+	return U_SUCCESS(errorCode) && normalized;
+}
+
+/// Convert UTF-8 string to Normalization Form C
+std::string unicode::utf8::to_nfc(std::string_view bytes)
+{
+	std::string result;
+	normalize_to(bytes, result);
+	return result;
+}
+
+/// Are UTF-8 strings canonically equivalent?
+bool unicode::utf8::canonically_equal(
+	std::string_view lhs, 
+	std::string_view rhs
+) noexcept
+{
+	if (lhs == rhs) { return true; }
+	auto lhs_nfc = is_nfc(lhs), rhs_nfc = is_nfc(rhs);
+	if (lhs_nfc && rhs_nfc) { return false; }
+
+	// Buffers are reused, so comparison doesn't allocate for short strings
+	thread_local std::string lhs_buffer, rhs_buffer;
+	if (!lhs_nfc) { normalize_to(lhs, lhs_buffer); }
+	if (!rhs_nfc) { normalize_to(rhs, rhs_buffer); }
+	return 
+		(lhs_nfc ? lhs : std::string_view(lhs_buffer)) == 
+		(rhs_nfc ? rhs : std::string_view(rhs_buffer));
+}
+
+/// Get hash of NFC form of UTF-8 string
+size_t unicode::utf8::canonical_hash(std::string_view bytes) noexcept
+{
+	if (is_nfc(bytes)) { return std::hash<std::string_view>{}(bytes); }
+
+	thread_local std::string buffer;
+	normalize_to(bytes, buffer);
+	return std::hash<std::string_view>{}(buffer);
+}
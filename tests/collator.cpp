@@ -0,0 +1,242 @@
+#include "unicode/collator.hpp"
+#include "unicode/utf8/compare.hpp"
+#include "unicode/sort_key.hpp"
+#include "unicode/string_view.hpp"
+
+#include <gtest/gtest.h>
+
+#include <unicode/locid.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace unicode;
+
+TEST(collator, compare)
+{
+	collator coll("en");
+	ASSERT_TRUE(coll);
+
+	EXPECT_EQ(coll.compare("abcd", "abcd"), std::strong_ordering::equal);
+	EXPECT_EQ(coll.compare("á", "á"), std::strong_ordering::equal);
+	EXPECT_EQ(coll.compare("1", "2"), std::strong_ordering::less);
+	EXPECT_EQ(coll.compare("a", "B"), std::strong_ordering::less);
+	EXPECT_EQ(utf8::compare("в", "б", coll), std::strong_ordering::greater);
+}
+
+TEST(collator, strength)
+{
+	collator tertiary("en", collation_strength::tertiary);
+	EXPECT_NE(tertiary.compare("a", "A"), std::strong_ordering::equal);
+
+	collator secondary("en", collation_strength::secondary);
+	EXPECT_EQ(secondary.compare("a", "A"), std::strong_ordering::equal);
+	EXPECT_NE(secondary.compare("a", "á"), std::strong_ordering::equal);
+
+	collator primary("en", collation_strength::primary);
+	EXPECT_EQ(primary.compare("a", "Á"), std::strong_ordering::equal);
+}
+
+TEST(collator, locale)
+{
+	// 'ä' is sorted after 'z' in swedish, but not in german
+	EXPECT_EQ(collator("de").compare("ä", "z"), std::strong_ordering::less);
+	EXPECT_EQ(collator("sv").compare("ä", "z"), std::strong_ordering::greater);
+}
+
+TEST(collator, cached)
+{
+	auto &coll = collator::cached("sv");
+	EXPECT_EQ(&coll, &collator::cached("sv"));
+	EXPECT_NE(&coll, &collator::cached("sv", collation_strength::primary));
+	EXPECT_NE(&coll, &collator::cached("de"));
+	EXPECT_EQ(coll.locale(), "sv");
+	EXPECT_EQ(coll.compare("ä", "z"), std::strong_ordering::greater);
+}
+
+TEST(collator, invalidate_cache)
+{
+	auto previous = icu::Locale::getDefault();
+
+	UErrorCode errorCode = U_ZERO_ERROR;
+	icu::Locale::setDefault(icu::Locale("de"), errorCode);
+	collator::invalidate_cache();
+	EXPECT_EQ(utf8::compare("ä", "z"), std::strong_ordering::less);
+
+	icu::Locale::setDefault(icu::Locale("sv"), errorCode);
+	collator::invalidate_cache();
+	EXPECT_EQ(utf8::compare("ä", "z"), std::strong_ordering::greater);
+
+	icu::Locale::setDefault(previous, errorCode);
+	collator::invalidate_cache();
+	ASSERT_TRUE(U_SUCCESS(errorCode));
+}
+
+TEST(sort_key, compare)
+{
+	collator coll("en");
+
+	EXPECT_EQ(sort_key("abcd", coll), sort_key("abcd", coll));
+	// Denormalized and normalized unicode 'a' with acute
+	EXPECT_EQ(sort_key("á", coll), sort_key("á", coll));
+	EXPECT_LT(sort_key("1", coll), sort_key("2", coll));
+	EXPECT_LT(sort_key("a", coll), sort_key("B", coll));
+	EXPECT_LT(sort_key("ab", coll), sort_key("abc", coll));
+	EXPECT_GT(sort_key("в", coll), sort_key("б", coll));
+
+	collator swedish("sv");
+	EXPECT_GT(sort_key("ä", swedish), sort_key("z", swedish));
+}
+
+TEST(sort_key, views)
+{
+	collator coll("en");
+
+	unicode::string_view view = "Привет";
+	EXPECT_EQ(view.sort_key(coll), sort_key("Привет", coll));
+
+	character_view character("á");
+	EXPECT_EQ(character.sort_key(coll), sort_key("á", coll));
+
+	auto copy = view.sort_key(coll);
+	copy = character.sort_key(coll);
+	EXPECT_EQ(copy, character.sort_key(coll));
+}
+
+TEST(sort_key, make_sort_keys)
+{
+	collator coll("en");
+
+	std::vector<unicode::string_view> strings = {
+		"b", "A", "á", "", "Привет", "á", "a"
+	};
+	auto keys = make_sort_keys(strings, coll);
+	ASSERT_EQ(keys.size(), strings.size());
+
+	size_t total = 0;
+	for (size_t i = 0; i < strings.size(); ++i)
+	{
+		EXPECT_EQ(keys[i], strings[i].sort_key(coll).view());
+		total += keys[i].size();
+
+		for (size_t j = 0; j < strings.size(); ++j)
+		{
+			EXPECT_EQ(
+				keys[i] <=> keys[j],
+				coll.compare(strings[i], strings[j])
+			);
+		}
+	}
+	EXPECT_EQ(keys.bytes().size(), total);
+
+	EXPECT_EQ(
+		std::hash<sort_key_view>{}(keys[2]),
+		std::hash<sort_key_view>{}(keys[5])
+	);
+}
+
+TEST(sort_key, sort)
+{
+	std::vector<unicode::string_view> strings = {
+		"b", "A", "á", "", "Привет", "á", "a", "ä", "z", "Ab"
+	};
+	auto expected = strings;
+	std::ranges::sort(expected);
+
+	unicode::sort(strings);
+	EXPECT_TRUE(std::equal(
+		strings.begin(), strings.end(), expected.begin(), expected.end()
+	));
+
+	// 'ä' is sorted after 'z' in swedish
+	unicode::sort(strings, "sv");
+	auto position = [&](const char *string)
+	{
+		return std::ranges::find(strings, string) - strings.begin();
+	};
+	EXPECT_LT(position("a"), position("z"));
+	EXPECT_GT(position("ä"), position("z"));
+}
+
+TEST(sort_key, parallel_sort)
+{
+	std::vector<std::string> words = {
+		"b", "A", "á", "", "Привет", "á", "a", "ä", "z", "Ab", "中文", "ß"
+	};
+	std::vector<std::string> strings;
+	std::mt19937 random(42);
+	for (size_t i = 0; i < 100'000; ++i)
+	{
+		strings.push_back(
+			words[random() % words.size()] + words[random() % words.size()]
+		);
+	}
+
+	auto sequential = strings;
+	unicode::sort(sequential, "sv", unicode::execution::seq);
+	unicode::sort(strings, "sv", unicode::execution::par);
+	EXPECT_EQ(strings, sequential);
+
+	collator coll("sv");
+	EXPECT_TRUE(std::ranges::is_sorted(
+		strings, 
+		[&](auto &lhs, auto &rhs) { return coll.compare(lhs, rhs) < 0; }
+	));
+}
+
+TEST(collator, equal)
+{
+	collator coll("en");
+
+	EXPECT_TRUE(coll.equal("identifier", "identifier"));
+	EXPECT_FALSE(coll.equal("identifier", "Identifier"));
+	EXPECT_TRUE(coll.equal("Привет", "Привет"));
+	// Denormalized and normalized unicode 'a' with acute
+	EXPECT_TRUE(coll.equal("á", "á"));
+	EXPECT_TRUE(utf8::equal("á", "á", coll));
+
+	collator secondary("en", collation_strength::secondary);
+	EXPECT_TRUE(secondary.equal("identifier", "IDENTIFIER"));
+}
+
+TEST(collator, ascii_fast_path)
+{
+	EXPECT_TRUE(collator("en").has_ascii_fast_path());
+	EXPECT_TRUE(collator("ru").has_ascii_fast_path());
+	// Contraction "ch"
+	EXPECT_FALSE(collator("cs").has_ascii_fast_path());
+	// Dotless i
+	EXPECT_FALSE(collator("tr").has_ascii_fast_path());
+	// Numeric ordering
+	EXPECT_FALSE(collator("en-u-kn").has_ascii_fast_path());
+
+	std::vector<std::string> strings = {
+		"", " ", "a", "A", "b", "B", "ab", "aB", "Ab", "a b", "a-b", "a_b", 
+		"abc", "abC", "x1", "x10", "x2", "X1", "_id", "id", "id_", "ID", 
+		"{}", "~", "!", "0", "9", "10", "file.txt", "file_1.txt"
+	};
+	for (auto strength : {
+		collation_strength::primary,
+		collation_strength::secondary,
+		collation_strength::tertiary,
+		collation_strength::quaternary,
+		collation_strength::identical
+	})
+	{
+		collator coll("en", strength);
+		ASSERT_TRUE(coll.has_ascii_fast_path());
+		for (auto &lhs : strings)
+		{
+			for (auto &rhs : strings)
+			{
+				// Sort keys are always built by ICU
+				auto expected = sort_key(lhs, coll) <=> sort_key(rhs, coll);
+				EXPECT_EQ(coll.compare(lhs, rhs), expected) 
+					<< lhs << " <=> " << rhs;
+				EXPECT_EQ(coll.equal(lhs, rhs), expected == 0) 
+					<< lhs << " == " << rhs;
+			}
+		}
+	}
+}
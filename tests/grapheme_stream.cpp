@@ -0,0 +1,129 @@
+#include "unicode/grapheme_stream.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unicode;
+
+/// Get characters of text, split by layout
+static std::vector<std::string> characters(std::string_view text)
+{
+	std::vector<std::string> result;
+	auto layout = layout::of(text);
+	for (size_t i = 0; i < layout.size(); ++i)
+	{
+		auto block = layout[i];
+		auto end = i + 1 < layout.size() ? 
+			layout[i + 1].byte_offset : text.size();
+		for (
+			auto byte = block.byte_offset; 
+			byte < end; 
+			byte += block.character_size
+		)
+		{
+			result.emplace_back(text.substr(byte, block.character_size));
+		}
+	}
+	return result;
+}
+
+/// Get characters of text, pushed to stream by chunks of specified sizes
+static std::vector<std::string> streamed(
+	std::string_view text, 
+	const std::vector<size_t> &chunk_sizes
+)
+{
+	std::vector<std::string> result;
+	auto collect = [&](character_view c) { result.emplace_back(c); };
+
+	grapheme_stream stream;
+	for (size_t i = 0, position = 0; position < text.size(); ++i)
+	{
+		auto size = chunk_sizes[i % chunk_sizes.size()];
+		stream.push_characters(text.substr(position, size), collect);
+		position += size;
+		EXPECT_EQ(
+			stream.bytes() + stream.pending_bytes(), 
+			std::min(position, text.size())
+		);
+	}
+	stream.finish_characters(collect);
+	EXPECT_EQ(stream.bytes(), text.size());
+	EXPECT_EQ(stream.characters(), result.size());
+	EXPECT_EQ(stream.pending_bytes(), 0);
+	return result;
+}
+
+TEST(grapheme_stream, chunks)
+{
+	std::string_view text = 
+		"🇺🇸: Hello, world!\r\n"
+		"🇷🇺: Привет, мир!\n"
+		"Café 👨‍👩‍👧 👍🏽 🇺🇸🇷🇺🇨🇳\n"
+		"I💜Unicode";
+
+	auto expected = characters(text);
+	for (size_t size = 1; size <= 16; ++size)
+	{
+		EXPECT_EQ(streamed(text, {size}), expected) << size;
+	}
+	EXPECT_EQ(streamed(text, {text.size()}), expected);
+	EXPECT_EQ(streamed(text, {3, 1, 7, 2}), expected);
+}
+
+TEST(grapheme_stream, runs)
+{
+	grapheme_stream stream;
+	std::vector<std::pair<size_t, size_t>> runs;
+	auto collect = [&](const character_run &run) 
+	{ 
+		runs.emplace_back(run.character_size, run.size()); 
+	};
+	stream.push("abc", collect);
+	stream.push("de", collect);
+	// Last character may still join with combining mark
+	EXPECT_EQ(stream.pending_bytes(), 1);
+	stream.push("́", collect);
+	stream.finish(collect);
+
+	std::vector<std::pair<size_t, size_t>> expected = {{1, 2}, {1, 2}, {3, 1}};
+	EXPECT_EQ(runs, expected);
+}
+
+TEST(grapheme_stream, bounded_carry)
+{
+	grapheme_stream stream;
+	size_t count = 0;
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		stream.push_characters("क्षत्रिय नमस्ते ", [&](auto) { ++count; });
+		EXPECT_LT(stream.pending_bytes(), 16);
+	}
+	stream.finish_characters([&](auto) { ++count; });
+	EXPECT_EQ(count, 1000 * characters("क्षत्रिय नमस्ते ").size());
+}
+
+TEST(grapheme_stream, random)
+{
+	std::vector<std::string> pieces = {
+		"a", " ", "\n", "\r", "\r\n", "é", "́", "‍", "п", "你", "한", "ᄀ", 
+		"ᅡ", "🇺", "🇸", "👩", "🏽", "क", "्", "\xFF"
+	};
+
+	std::default_random_engine engine{5};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> chunk(1, 9);
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		std::string text;
+		for (size_t n = 40; n > 0; --n)
+		{
+			text += pieces[piece(engine)];
+		}
+		std::vector<size_t> sizes{chunk(engine), chunk(engine), chunk(engine)};
+		EXPECT_EQ(streamed(text, sizes), characters(text)) << text;
+	}
+}
@@ -0,0 +1,737 @@
+#include "unicode/layout.hpp"
+#include "unicode/layout_cache.hpp"
+#include "unicode/string_view.hpp"
+#include "unicode/utf8/grapheme.hpp"
+
+#include <array>
+#include <memory_resource>
+#include <random>
+#include <thread>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <unicode/uchar.h>
+
+#include "../sources/icu.hpp"
+
+using namespace unicode;
+
+/// Get sizes of characters, found by ICU break iterator
+static std::vector<size_t> icu_character_sizes(std::string_view text)
+{
+	std::vector<size_t> sizes;
+	if (text.empty()) { return sizes; }
+
+	auto utext = openUText(text);
+	auto it = getCharacterBreakIterator(utext.get());
+	for (
+		auto start = it->first(), end = it->next();
+		end != icu::BreakIterator::DONE;
+		start = end, end = it->next()
+	)
+	{
+		sizes.push_back(end - start);
+	}
+	return sizes;
+}
+
+/// Get sizes of characters from layout
+static std::vector<size_t> character_sizes(
+	const layout &layout, 
+	size_t total_size
+)
+{
+	std::vector<size_t> sizes;
+	for (size_t i = 0; i < layout.size(); ++i)
+	{
+		auto block = layout[i];
+		auto end = i + 1 < layout.size() ? 
+			layout[i + 1].byte_offset : total_size;
+		EXPECT_EQ((end - block.byte_offset) % block.character_size, 0);
+		for (auto byte = block.byte_offset; byte < end; byte += block.character_size)
+		{
+			EXPECT_EQ(
+				layout.offset(i) + 
+					(byte - block.byte_offset) / block.character_size, 
+				sizes.size()
+			);
+			sizes.push_back(block.character_size);
+		}
+	}
+	return sizes;
+}
+
+/// Check that layout matches ICU segmentation
+static void expect_icu_layout(std::string_view text)
+{
+	auto layout = layout::of(text);
+	for (size_t i = 1; i < layout.size(); ++i)
+	{
+		EXPECT_NE(
+			layout[i - 1].character_size, 
+			layout[i].character_size
+		) << "blocks aren't merged";
+	}
+	EXPECT_EQ(character_sizes(layout, text.size()), icu_character_sizes(text))
+		<< text;
+}
+
+TEST(utf8, standalone_ranges)
+{
+	for (auto [first, last] : utf8::standalone_ranges)
+	{
+		for (auto c = first; c <= last; ++c)
+		{
+			ASSERT_TRUE(utf8::is_standalone(c));
+
+			auto property = u_getIntPropertyValue(
+				c, UCHAR_GRAPHEME_CLUSTER_BREAK
+			);
+			EXPECT_TRUE(
+				property == U_GCB_OTHER || 
+				property == U_GCB_CONTROL ||
+				property == U_GCB_LF ||
+				property == U_GCB_LV ||
+				property == U_GCB_LVT
+			) << std::hex << uint32_t(c);
+			EXPECT_FALSE(u_hasBinaryProperty(c, UCHAR_EXTENDED_PICTOGRAPHIC))
+				<< std::hex << uint32_t(c);
+		}
+	}
+	EXPECT_FALSE(utf8::is_standalone('\r'));
+	EXPECT_FALSE(utf8::is_standalone(U'\u0301'));
+	EXPECT_FALSE(utf8::is_standalone(U'\u200D'));
+}
+
+TEST(utf8, decode)
+{
+	EXPECT_EQ(utf8::decode("a").value, U'a');
+	EXPECT_EQ(utf8::decode("ж").value, U'ж');
+	EXPECT_EQ(utf8::decode("你").size, 3);
+	EXPECT_EQ(utf8::decode("🇺").value, U'🇺');
+	EXPECT_EQ(utf8::decode("\xC0\x80").size, 0);
+	EXPECT_EQ(utf8::decode("\xED\xA0\x80").size, 0);
+	EXPECT_EQ(utf8::decode("\xF4\x90\x80\x80").size, 0);
+	EXPECT_EQ(utf8::decode("\xE4\xBD").size, 0);
+}
+
+TEST(layout, empty)
+{
+	auto layout = layout::of("");
+	EXPECT_TRUE(layout.empty());
+	EXPECT_EQ(layout.size(), 0);
+
+	// Empty layout is serialized without buffer
+	EXPECT_EQ(layout.serialized_size(), 0);
+	layout.serialize(nullptr);
+	auto restored = layout::deserialize({}, 0, layout.integer_width());
+	EXPECT_TRUE(restored.empty());
+	EXPECT_EQ(restored, layout);
+}
+
+TEST(layout, ascii)
+{
+	auto layout = layout::of("Hello, world!\n");
+	ASSERT_EQ(layout.size(), 1);
+	EXPECT_EQ(layout[0].character_size, 1);
+
+	expect_icu_layout("Hello, world!\n");
+	expect_icu_layout(std::string(1000, 'a'));
+}
+
+TEST(layout, clusters)
+{
+	for (auto text : {
+		"á", "́", "áb", "é̂x",
+		"\r\n", "\r", "\n\r", "a\r\nb", "\r\r\n\n", "\ŕ",
+		"Привет, мир!", "й", "й", "你好，世界！",
+		"こんにちは", "が", "안녕하세요", "각",
+		"각", "ᄀ가", "🇺🇸🇷🇺", "🇺🇸🇷", "a🇺🇸b",
+		"👨‍👩‍👧", "a‍b", "👍🏽", "I💜Unicode", "؀a", "x؀a",
+		"क्ष", "กำ", "\xFF\xFE" "abc", "ab\xE0\x80", 
+		"©‍®", "a️", "­́"
+	})
+	{
+		expect_icu_layout(text);
+	}
+}
+
+TEST(layout, random)
+{
+	std::vector<std::string> pieces = {
+		"a", "Z", " ", "\n", "\r", "\r\n", "\t", "é", "́", 
+		"̈", "‍", "‌", "️", "п", "Ж", "你", "。", "あ",
+		"゙", "ア", "한", "ᄀ", "ᅡ", "ᆨ", "🇺", "🇸",
+		"👩", "🏽", "❤", "؀", "ا", "ً", "क", "्",
+		"ก", "ำ", "©", "­", "ß", "Ω", "ｶ", "ﾞ", 
+		"\U00020000", "\xFF"
+	};
+
+	std::default_random_engine engine{42};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> length(1, 12);
+	for (size_t i = 0; i < 5000; ++i)
+	{
+		std::string text;
+		for (size_t n = length(engine); n > 0; --n)
+		{
+			text += pieces[piece(engine)];
+		}
+		expect_icu_layout(text);
+	}
+}
+
+TEST(layout_builder, reuse)
+{
+	layout_builder builder;
+	for (auto text : {
+		"á", "abc", "👨‍👩‍👧 family", "", "🇺🇸🇷🇺", "Привет", "á"
+	})
+	{
+		auto layout = builder.build(text);
+		auto expected = layout::of(text);
+		EXPECT_EQ(layout, expected);
+		expect_icu_layout(text);
+	}
+}
+
+TEST(layout_builder, extend)
+{
+	std::vector<std::string> pieces = {
+		"a", " ", "\r", "\r\n", "é", "́", "‍", "п", "你", "한", "ᄀ", 
+		"🇺", "👩", "🏽", "क", "्", "\xFF"
+	};
+
+	std::default_random_engine engine{7};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> step(1, 8);
+	layout_builder builder;
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		std::string text;
+		for (size_t n = 40; n > 0; --n)
+		{
+			text += pieces[piece(engine)];
+		}
+
+		layout layout(text.size());
+		layout_progress progress;
+		while (progress.bytes < text.size())
+		{
+			auto previous = progress;
+			builder.extend(layout, text, progress, progress.bytes + step(engine));
+			ASSERT_GT(progress.bytes, previous.bytes);
+			ASSERT_GT(progress.characters, previous.characters);
+		}
+		EXPECT_EQ(layout, layout::of(text)) << text;
+	}
+}
+
+TEST(layout_builder, update)
+{
+	std::vector<std::string> pieces = {
+		"a", " ", "\r", "\n", "\r\n", "é", "́", "‍", "п", "你", "한", "ᄀ", 
+		"ᅡ", "🇺", "🇸", "👩", "❤", "🏽", "क", "्", "\xFF"
+	};
+
+	std::default_random_engine engine{11};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> length(0, 4);
+	auto random_text = [&](size_t pieces_count)
+	{
+		std::string text;
+		for (; pieces_count > 0; --pieces_count)
+		{
+			text += pieces[piece(engine)];
+		}
+		return text;
+	};
+
+	layout_builder builder;
+	for (size_t i = 0; i < 3000; ++i)
+	{
+		auto text = random_text(30);
+
+		std::uniform_int_distribution<size_t> offset(0, text.size());
+		byte_range changed{.offset = offset(engine)};
+		changed.size = std::min(length(engine), text.size() - changed.offset);
+		auto inserted = random_text(length(engine));
+
+		auto edited = text;
+		edited.replace(changed.offset, changed.size, inserted);
+
+		// Complete layout
+		{
+			auto layout = layout::of(text);
+			layout_progress progress{
+				.characters = layout.empty() ? 0 : (
+					layout.offset(layout.size() - 1) + 
+					(text.size() - layout.back().byte_offset) / 
+						layout.back().character_size
+				),
+				.bytes = text.size()
+			};
+			builder.update(layout, progress, edited, changed, inserted.size());
+
+			auto expected = layout::of(edited);
+			EXPECT_EQ(layout, expected) << text << " -> " << edited;
+			EXPECT_EQ(progress.bytes, edited.size());
+
+			layout_progress full;
+			unicode::layout rebuilt(edited.size());
+			builder.extend(rebuilt, edited, full, edited.size());
+			EXPECT_EQ(progress.characters, full.characters);
+		}
+
+		// Partial layout
+		{
+			unicode::layout layout(text.size());
+			layout_progress progress;
+			builder.extend(layout, text, progress, text.size() / 2);
+			builder.update(layout, progress, edited, changed, inserted.size());
+			builder.extend(layout, edited, progress, edited.size());
+
+			EXPECT_EQ(layout, layout::of(edited)) << text << " -> " << edited;
+		}
+	}
+}
+
+TEST(layout, parallel)
+{
+	std::vector<std::string> pieces = {
+		"a", " ", "\n", "\r", "\r\n", "é", "́", "‍", "п", "你", "한", "ᄀ", 
+		"ᅡ", "🇺", "🇸", "👩", "🏽", "क", "्", "\xFF"
+	};
+
+	std::default_random_engine engine{3};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	auto executor = [](auto task) { task(); };
+	for (size_t i = 0; i < 1000; ++i)
+	{
+		std::string text;
+		for (size_t n = 50; n > 0; --n)
+		{
+			text += pieces[piece(engine)];
+		}
+		for (size_t chunk_size : {1, 7, 32})
+		{
+			EXPECT_EQ(layout::of(text, executor, chunk_size), layout::of(text))
+				<< text;
+		}
+	}
+}
+
+/// Resource, that counts allocations
+class counting_resource : public std::pmr::memory_resource
+{
+public:
+	/// Number of allocated bytes, that weren't freed yet
+	size_t allocated = 0;
+	/// Number of allocations
+	size_t allocations = 0;
+
+private:
+	void *do_allocate(size_t bytes, size_t alignment) override
+	{
+		allocated += bytes;
+		++allocations;
+		return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+	}
+	void do_deallocate(void *p, size_t bytes, size_t alignment) override
+	{
+		allocated -= bytes;
+		std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+	}
+	bool do_is_equal(const memory_resource &other) const noexcept override
+	{
+		return this == &other;
+	}
+};
+
+TEST(layout, memory_resource)
+{
+	std::string_view text = "a б c д e ф g 你 h 👍🏽 i";
+	counting_resource resource;
+	{
+		auto layout = layout::of(text, &resource);
+		EXPECT_EQ(layout.memory_resource(), &resource);
+		EXPECT_EQ(layout, layout::of(text));
+		EXPECT_EQ(resource.allocated, layout.allocated_bytes());
+		EXPECT_NE(resource.allocations, 0);
+
+		// Copies use default resource, like pmr containers
+		auto copy = layout;
+		EXPECT_EQ(copy.memory_resource(), std::pmr::get_default_resource());
+		EXPECT_EQ(resource.allocated, layout.allocated_bytes());
+
+		// Move keeps resource
+		auto moved = std::move(layout);
+		EXPECT_EQ(moved.memory_resource(), &resource);
+		EXPECT_EQ(resource.allocated, moved.allocated_bytes());
+
+		// Move to layout with other resource copies blocks
+		unicode::layout other;
+		other = std::move(moved);
+		EXPECT_EQ(other, copy);
+		EXPECT_EQ(resource.allocated, 0);
+	}
+
+	{
+		unicode::string_view view(text, &resource);
+		EXPECT_EQ(view.blocks().memory_resource(), &resource);
+		EXPECT_EQ(view.size(), unicode::string_view(text).size());
+		EXPECT_NE(resource.allocated, 0);
+	}
+	EXPECT_EQ(resource.allocated, 0);
+
+	// Layouts of one request are freed at once
+	std::array<std::byte, 4096> buffer;
+	std::pmr::monotonic_buffer_resource arena(
+		buffer.data(), buffer.size(), std::pmr::null_memory_resource()
+	);
+	for (size_t i = 0; i < 10; ++i)
+	{
+		unicode::string_view view(text, unicode::lazy, &arena);
+		EXPECT_EQ(view.back(), "i");
+	}
+}
+
+TEST(layout_builder, threads)
+{
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < 4; ++i)
+	{
+		threads.emplace_back([] 
+		{
+			for (size_t i = 0; i < 100; ++i)
+			{
+				expect_icu_layout("á 👍🏽 🇺🇸 x");
+			}
+		});
+	}
+	for (auto &thread : threads) { thread.join(); }
+}
+
+TEST(layout_cache, hits)
+{
+	layout_cache cache(8, 32);
+	EXPECT_EQ(cache.capacity(), 8);
+	EXPECT_EQ(cache.max_string_size(), 32);
+
+	std::string_view texts[] = {
+		"", "abc", "á 👍🏽 🇺🇸 x", "Привет", 
+		"string, that is longer than limit of cache"
+	};
+	for (size_t i = 0; i < 3; ++i)
+	{
+		for (auto text : texts)
+		{
+			EXPECT_EQ(cache.of(text), layout::of(text)) << text;
+		}
+	}
+
+	string_view view("á 👍🏽 🇺🇸 x", cache);
+	EXPECT_EQ(view.size(), 7);
+	EXPECT_EQ(view[2], "👍🏽");
+
+	cache.clear();
+	EXPECT_EQ(cache.of("abc"), layout::of("abc"));
+}
+
+TEST(layout, batch)
+{
+	std::string fragmented, long_ascii(70000, 'a');
+	for (size_t i = 0; i < 1000; ++i) { fragmented += i % 3 ? "한" : "a"; }
+	std::string mixed = fragmented;
+	for (size_t i = 0; i < 1000; ++i) { mixed += i % 2 ? "e\u0301" : "x"; }
+
+	std::vector<std::string> strings = {
+		"", "abc", "line\r\n", "á 👍🏽 🇺🇸 x", "Привет, мир!", 
+		fragmented, mixed, long_ascii, long_ascii + "👍🏽", "e\u0301"
+	};
+	std::vector<std::string_view> views(strings.begin(), strings.end());
+	auto batch = layout::of_batch(views);
+	ASSERT_EQ(batch.size(), strings.size());
+
+	size_t allocated = 0;
+	for (size_t i = 0; i < strings.size(); ++i)
+	{
+		auto expected = layout::of(strings[i]);
+		EXPECT_EQ(batch[i], expected) << i;
+		EXPECT_EQ(batch[i].strategy(), expected.strategy()) << i;
+		EXPECT_EQ(batch[i].has_index(), expected.has_index()) << i;
+		EXPECT_EQ(batch[i].integer_width(), expected.integer_width()) << i;
+		allocated += expected.allocated_bytes();
+	}
+	EXPECT_EQ(batch.allocated_bytes(), allocated);
+
+	// Layout, moved out of batch, still uses memory of batch
+	string_view view(strings[3], std::move(batch[3]));
+	EXPECT_EQ(view.size(), 7);
+	EXPECT_EQ(view[2], "👍🏽");
+
+	EXPECT_TRUE(layout::of_batch({}).empty());
+}
+
+TEST(layout_cache, threads)
+{
+	// Small cache with many strings evicts entries, that other threads read
+	layout_cache cache(16);
+	std::vector<std::string> strings;
+	std::vector<layout> expected;
+	for (size_t i = 0; i < 64; ++i)
+	{
+		strings.push_back("á" + std::to_string(i) + " 👍🏽 Привет");
+		expected.push_back(layout::of(strings.back()));
+	}
+
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < 4; ++t)
+	{
+		threads.emplace_back([&, t] 
+		{
+			std::mt19937 random(t);
+			for (size_t i = 0; i < 10'000; ++i)
+			{
+				// Half of lookups go to a few popular strings
+				auto index = random() % (i % 2 == 0 ? 4 : strings.size());
+				EXPECT_EQ(cache.of(strings[index]), expected[index]);
+			}
+		});
+	}
+	for (auto &thread : threads) { thread.join(); }
+}
+
+TEST(layout, compact)
+{
+	// Single block doesn't need heap
+	auto ascii = layout::of(std::string(100000, 'a'));
+	EXPECT_EQ(ascii.size(), 1);
+	EXPECT_EQ(ascii.integer_width(), 4);
+	EXPECT_EQ(ascii.allocated_bytes(), 0);
+
+	auto russian = layout::of("Привет, мир!");
+	EXPECT_EQ(russian.size(), 4);
+	EXPECT_EQ(russian.integer_width(), 2);
+	EXPECT_EQ(russian.allocated_bytes(), 0);
+
+	auto mixed = layout::of("a б c д e ф g");
+	EXPECT_EQ(mixed.size(), 7);
+	EXPECT_EQ(mixed.allocated_bytes(), 7 * 3 * 2);
+	EXPECT_EQ(mixed.block_index_for_character(0), 0);
+	EXPECT_EQ(mixed.block_index_for_character(2), 1);
+	EXPECT_EQ(mixed.block_index_for_character(3), 2);
+	EXPECT_EQ(mixed.block_index_for_character(12), 6);
+
+	auto copy = mixed;
+	EXPECT_EQ(copy, mixed);
+	auto moved = std::move(copy);
+	EXPECT_EQ(moved, mixed);
+	EXPECT_TRUE(copy.empty());
+	copy = moved;
+	EXPECT_EQ(copy, mixed);
+	copy = russian;
+	EXPECT_EQ(copy, russian);
+}
+
+TEST(layout, widening)
+{
+	layout layout;
+	EXPECT_EQ(layout.integer_width(), 2);
+
+	std::vector<std::pair<size_t, block>> blocks;
+	for (size_t i = 0; i < 20; ++i)
+	{
+		size_t offset = i << (i * 3 % 64 > 40 ? 40 : i * 3 % 64);
+		if (!blocks.empty() && offset <= blocks.back().first) 
+		{ 
+			offset = blocks.back().first + 1; 
+		}
+		blocks.emplace_back(
+			offset, block{.character_size = i % 3 + 1, .byte_offset = 2 * offset}
+		);
+		layout.push_back(blocks.back().first, blocks.back().second);
+	}
+	EXPECT_EQ(layout.integer_width(), 8);
+	ASSERT_EQ(layout.size(), blocks.size());
+	for (size_t i = 0; i < blocks.size(); ++i)
+	{
+		EXPECT_EQ(layout.offset(i), blocks[i].first);
+		EXPECT_EQ(layout[i].character_size, blocks[i].second.character_size);
+		EXPECT_EQ(layout[i].byte_offset, blocks[i].second.byte_offset);
+		EXPECT_EQ(layout.block_index_for_character(blocks[i].first), i);
+	}
+}
+
+TEST(layout, search_index)
+{
+	std::string text;
+	for (size_t i = 0; i < 1000; ++i) { text += i % 7 ? "abcdefgh б" : "é "; }
+	auto indexed = layout::of(text);
+	ASSERT_GE(indexed.size(), 256u);
+	EXPECT_TRUE(indexed.has_index());
+	EXPECT_FALSE(layout::of("a б").has_index());
+
+	auto expect_blocks = [&](const layout &layout, size_t characters)
+	{
+		size_t expected = 0;
+		for (size_t i = 0; i < characters; ++i)
+		{
+			while (
+				expected + 1 < layout.size() && 
+				layout.offset(expected + 1) <= i
+			)
+			{
+				++expected;
+			}
+			ASSERT_EQ(layout.block_index_for_character(i), expected) << i;
+		}
+	};
+	unicode::string_view view(text);
+	expect_blocks(indexed, view.size());
+
+	auto copy = indexed;
+	EXPECT_TRUE(copy.has_index());
+	expect_blocks(copy, view.size());
+
+	auto restored = layout::deserialize(
+		[&]
+		{
+			std::vector<std::byte> bytes(indexed.serialized_size());
+			indexed.serialize(bytes.data());
+			return bytes;
+		}(),
+		indexed.size(),
+		indexed.integer_width()
+	);
+	EXPECT_TRUE(restored.has_index());
+	EXPECT_EQ(restored, indexed);
+
+	// Modified layouts fall back to binary search
+	copy.truncate(copy.offset(300));
+	EXPECT_FALSE(copy.has_index());
+	expect_blocks(copy, copy.offset(copy.size() - 1));
+	copy.push_back(view.size(), block{1, text.size()});
+	expect_blocks(copy, view.size());
+	copy.shrink_to_fit();
+	EXPECT_TRUE(copy.has_index());
+	expect_blocks(copy, view.size());
+}
+
+TEST(layout, sampled)
+{
+	std::vector<std::string> pieces = {
+		"a", "Z", " ", "\r\n", "é", "é", "п", "你", "한", "ᄀ", "ᅡ", 
+		"🇺", "🇸", "👩", "🏽", "❤️", "क", "्", "\xFF"
+	};
+
+	std::default_random_engine engine{17};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	for (size_t length : {1, 31, 32, 33, 500, 5000})
+	{
+		std::string text;
+		for (size_t n = length; n > 0; --n)
+		{
+			text += pieces[piece(engine)];
+		}
+
+		auto blocks = layout::of(text, layout_strategy::blocks);
+		auto sampled = layout::of(text, layout_strategy::sampled);
+		EXPECT_EQ(blocks.strategy(), layout_strategy::blocks);
+		EXPECT_EQ(sampled.strategy(), layout_strategy::sampled);
+		EXPECT_EQ(sampled, blocks);
+		EXPECT_EQ(blocks, sampled);
+
+		unicode::string_view expected(text, blocks);
+		unicode::string_view actual(text, sampled);
+		ASSERT_EQ(actual.size(), expected.size());
+		for (size_t i = 0; i < expected.size(); ++i)
+		{
+			ASSERT_EQ(
+				std::string_view(actual[i]), std::string_view(expected[i])
+			) << i;
+		}
+		EXPECT_TRUE(std::equal(
+			actual.begin(), actual.end(), expected.begin(), expected.end(),
+			[](auto lhs, auto rhs) 
+			{ 
+				return std::string_view(lhs) == std::string_view(rhs); 
+			}
+		));
+
+		auto character_of_byte = [](const layout &layout, size_t byte)
+		{
+			auto [index, offset, block] = layout.block_for_byte(byte);
+			return offset + (byte - block.byte_offset) / block.character_size;
+		};
+		for (size_t byte = 0; byte < text.size(); ++byte)
+		{
+			ASSERT_EQ(
+				character_of_byte(sampled, byte), 
+				character_of_byte(blocks, byte)
+			) << byte;
+		}
+
+		// Modification stores layout as blocks again
+		auto truncated = sampled;
+		truncated.truncate(expected.size() / 2);
+		EXPECT_EQ(truncated.strategy(), layout_strategy::blocks);
+		auto expected_truncated = blocks;
+		expected_truncated.truncate(expected.size() / 2);
+		EXPECT_EQ(truncated, expected_truncated);
+	}
+}
+
+TEST(layout, sampled_strategy)
+{
+	std::string fragmented, english;
+	for (size_t i = 0; i < 2000; ++i) 
+	{ 
+		fragmented += i % 2 ? "한" : "a"; 
+		english += "Lorem ipsum dolor sit amet. ";
+	}
+	english += "é";
+
+	// Fragmented text is sampled automatically and takes less memory
+	auto automatic = layout::of(fragmented);
+	EXPECT_EQ(automatic.strategy(), layout_strategy::sampled);
+	auto blocks = layout::of(fragmented, layout_strategy::blocks);
+	EXPECT_LT(automatic.allocated_bytes(), blocks.allocated_bytes() / 4);
+	EXPECT_LT(automatic.allocated_bytes(), fragmented.size());
+
+	EXPECT_EQ(layout::of(english).strategy(), layout_strategy::blocks);
+	auto sampled = layout::of(english, layout_strategy::sampled);
+	EXPECT_EQ(sampled.strategy(), layout_strategy::sampled);
+	EXPECT_EQ(sampled, layout::of(english));
+
+	// Clusters longer than byte size can't be sampled
+	std::string long_cluster = "b";
+	for (size_t i = 0; i < 150; ++i) { long_cluster += "́"; }
+	long_cluster += "a";
+	EXPECT_EQ(
+		layout::of(long_cluster, layout_strategy::sampled).strategy(), 
+		layout_strategy::blocks
+	);
+
+	// Copies, moves and serialized layouts keep sampling
+	auto copy = automatic;
+	EXPECT_EQ(copy.strategy(), layout_strategy::sampled);
+	EXPECT_EQ(copy, automatic);
+	auto moved = std::move(copy);
+	EXPECT_EQ(moved.strategy(), layout_strategy::sampled);
+	EXPECT_TRUE(copy.empty());
+
+	std::vector<std::byte> bytes(blocks.serialized_size());
+	blocks.serialize(bytes.data());
+	auto restored = layout::deserialize(
+		bytes, blocks.size(), blocks.integer_width()
+	);
+	EXPECT_EQ(restored.strategy(), layout_strategy::sampled);
+	EXPECT_EQ(restored, blocks);
+
+	moved.shrink_to_fit(layout_strategy::blocks);
+	EXPECT_EQ(moved.strategy(), layout_strategy::blocks);
+	EXPECT_EQ(moved, blocks);
+}
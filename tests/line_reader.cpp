@@ -0,0 +1,158 @@
+#include "unicode/line_reader.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unicode;
+
+/// Write content to file
+static void writeFile(
+	const std::filesystem::path &path,
+	std::string_view content
+)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(content.data(), content.size());
+}
+
+/// Temporary file, removed after test
+struct temporary_file
+{
+	std::filesystem::path path =
+		std::filesystem::temp_directory_path() / (
+			std::string("unicode_line_reader_") +
+			::testing::UnitTest::GetInstance()->current_test_info()->name() +
+			".txt"
+		);
+
+	~temporary_file() { std::filesystem::remove(path); }
+};
+
+/// Read all lines of file as strings
+static std::vector<std::string> readLines(
+	const std::filesystem::path &path,
+	line_reader::options settings
+)
+{
+	std::vector<std::string> lines;
+	line_reader reader(path, settings);
+	for (auto &line : reader)
+	{
+		EXPECT_EQ(line.size(), unicode::string_view(line).size());
+		lines.emplace_back(std::string_view(line));
+	}
+	return lines;
+}
+
+TEST(line_reader, lines)
+{
+	std::string long_line(100, 'a');
+	long_line += "👍🏽";
+	std::string content =
+		"🇺🇸: Hello, world!\n"
+		"🇷🇺: Привет, мир!\n"
+		"\n"
+		"🇨🇳: 你好，世界！\n" +
+		long_line + "\n" +
+		"I💜Unicode";
+	std::vector<std::string> expected = {
+		"🇺🇸: Hello, world!",
+		"🇷🇺: Привет, мир!",
+		"",
+		"🇨🇳: 你好，世界！",
+		long_line,
+		"I💜Unicode"
+	};
+	temporary_file file;
+	writeFile(file.path, content);
+
+	// Chunks split lines and characters, and lines are longer than chunks
+	for (size_t chunk_size : {1, 3, 7, 64, 4096})
+	{
+		for (size_t workers : {1, 3})
+		{
+			EXPECT_EQ(
+				readLines(file.path, {
+					.chunk_size = chunk_size,
+					.workers = workers,
+					.depth = 2
+				}),
+				expected
+			) << chunk_size << " " << workers;
+		}
+	}
+
+	// Delimiter at the end of file doesn't start empty line
+	writeFile(file.path, content + "\n");
+	EXPECT_EQ(readLines(file.path, {.chunk_size = 5}), expected);
+}
+
+TEST(line_reader, delimiter)
+{
+	temporary_file file;
+	writeFile(file.path, "a;é;;👍🏽\n");
+	EXPECT_EQ(
+		readLines(file.path, {.chunk_size = 2, .delimiter = ';'}),
+		(std::vector<std::string>{"a", "é", "", "👍🏽\n"})
+	);
+}
+
+TEST(line_reader, empty)
+{
+	temporary_file file;
+	writeFile(file.path, "");
+	line_reader reader(file.path);
+	ASSERT_TRUE(reader);
+	EXPECT_EQ(reader.next(), nullptr);
+	EXPECT_EQ(reader.next(), nullptr);
+
+	EXPECT_FALSE(reader.error());
+
+	line_reader missing(file.path.string() + ".missing");
+	EXPECT_FALSE(missing);
+	EXPECT_EQ(missing.error(), std::errc::no_such_file_or_directory);
+	EXPECT_EQ(missing.next(), nullptr);
+	EXPECT_TRUE(missing.begin() == missing.end());
+}
+
+#ifndef _WIN32
+TEST(line_reader, error)
+{
+	// Descriptor of directory is opened, but reading from it fails
+	line_reader reader(std::filesystem::temp_directory_path());
+	ASSERT_TRUE(reader);
+	EXPECT_EQ(reader.next(), nullptr);
+	EXPECT_EQ(reader.error(), std::errc::is_a_directory);
+}
+#endif
+
+TEST(line_reader, stop)
+{
+	std::string content;
+	for (size_t i = 0; i < 10000; ++i) { content += "Привет, мир!\n"; }
+	temporary_file file;
+	writeFile(file.path, content);
+
+	// Reader is destroyed, while background threads wait for consumer
+	{
+		line_reader reader(
+			file.path, {.chunk_size = 64, .workers = 2, .depth = 1}
+		);
+		auto *line = reader.next();
+		ASSERT_NE(line, nullptr);
+		EXPECT_EQ(*line, "Привет, мир!");
+	}
+
+	line_reader reader(file.path, {.chunk_size = 64, .workers = 2, .depth = 1});
+	auto moved = std::move(reader);
+	EXPECT_FALSE(reader);
+	size_t count = 0;
+	while (moved.next()) { ++count; }
+	EXPECT_EQ(count, 10000u);
+	EXPECT_FALSE(moved.error());
+}
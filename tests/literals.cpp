@@ -0,0 +1,63 @@
+#include "unicode/literals.hpp"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace unicode;
+using namespace unicode::literals;
+
+/// Check, that literal is split into the same characters as fresh view
+static void expect_fresh_layout(const unicode::string_view &literal)
+{
+	unicode::string_view fresh = std::string_view(literal);
+	ASSERT_EQ(literal.size(), fresh.size());
+	EXPECT_EQ(literal.blocks(), fresh.blocks());
+	for (size_t i = 0; i < fresh.size(); ++i)
+	{
+		EXPECT_EQ(std::string_view(literal[i]), std::string_view(fresh[i]));
+	}
+}
+
+TEST(literals, compile_time_layout)
+{
+	using ascii = literal_layout<"Hello, world!">;
+	static_assert(ascii::computed);
+	static_assert(ascii::characters == 13);
+	static_assert(ascii::block_count == 1);
+
+	using mixed = literal_layout<"Привет, мир!\r\n你好">;
+	static_assert(mixed::computed);
+	static_assert(mixed::characters == 15);
+	static_assert(mixed::blocks[1].offset == 6);
+	static_assert(mixed::blocks[1].block.character_size == 1);
+	static_assert(mixed::blocks[4].block.character_size == 2);
+	static_assert(mixed::blocks[4].block.byte_offset == 21);
+
+	using empty = literal_layout<"">;
+	static_assert(empty::computed && empty::characters == 0);
+
+	// Combining marks, emoji and flags need full grapheme cluster rules
+	static_assert(!literal_layout<"é">::computed);
+	static_assert(!literal_layout<"🇺🇸">::computed);
+	static_assert(!literal_layout<"a\xFF">::computed);
+}
+
+TEST(literals, usv)
+{
+	auto hello = "Hello, world!"_usv;
+	EXPECT_EQ(hello.size(), 13u);
+	EXPECT_EQ(hello[7], "w");
+	EXPECT_EQ(hello.blocks().allocated_bytes(), 0u);
+	expect_fresh_layout(hello);
+
+	expect_fresh_layout("Привет, мир!\r\n你好\r한국어"_usv);
+	expect_fresh_layout(""_usv);
+	EXPECT_TRUE(""_usv.empty());
+
+	// Literals with complex clusters are split at runtime
+	auto complex = "🇺🇸: é"_usv;
+	EXPECT_EQ(complex.size(), 4u);
+	EXPECT_EQ(complex[3], "é");
+	expect_fresh_layout(complex);
+}
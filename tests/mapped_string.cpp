@@ -0,0 +1,118 @@
+#include "unicode/mapped_string.hpp"
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace unicode;
+
+/// Write content to file
+static void writeFile(
+	const std::filesystem::path &path, 
+	std::string_view content
+)
+{
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	file.write(content.data(), content.size());
+}
+
+/// Temporary file, removed with its sidecar
+struct temporary_file
+{
+	std::filesystem::path path = 
+		std::filesystem::temp_directory_path() / (
+			std::string("unicode_mapped_string_") + 
+			::testing::UnitTest::GetInstance()->current_test_info()->name() + 
+			".txt"
+		);
+
+	~temporary_file()
+	{
+		std::filesystem::remove(path);
+		std::filesystem::remove(mapped_string::sidecar_path(path));
+	}
+};
+
+TEST(mapped_string, sidecar)
+{
+	std::string content = 
+		"🇺🇸: Hello, world!\n"
+		"🇷🇺: Привет, мир!\n"
+		"🇨🇳: 你好，世界！\n" 
+		"I💜Unicode";
+	temporary_file file;
+	writeFile(file.path, content);
+
+	{
+		mapped_string string(file.path);
+		ASSERT_TRUE(string);
+		EXPECT_FALSE(string.is_layout_loaded());
+		EXPECT_EQ(string.bytes(), content);
+		EXPECT_TRUE(string.save_layout());
+	}
+
+	mapped_string string(file.path);
+	ASSERT_TRUE(string);
+	EXPECT_TRUE(string.is_layout_loaded());
+
+	unicode::string_view expected = content;
+	EXPECT_EQ(string.view().blocks(), expected.blocks());
+	ASSERT_EQ(string.view().size(), expected.size());
+	for (size_t i = 0; i < expected.size(); ++i)
+	{
+		EXPECT_EQ(string.view()[i], expected[i]);
+	}
+
+	auto moved = std::move(string);
+	EXPECT_EQ(moved.view().back(), "e");
+}
+
+TEST(mapped_string, stale_sidecar)
+{
+	temporary_file file;
+	writeFile(file.path, "Привет, мир!");
+	EXPECT_TRUE(mapped_string(file.path).save_layout());
+
+	// Same size, different content
+	writeFile(file.path, "Привет, мир?");
+	{
+		mapped_string string(file.path);
+		EXPECT_FALSE(string.is_layout_loaded());
+		EXPECT_EQ(string.view()[11], "?");
+		EXPECT_TRUE(string.save_layout());
+	}
+
+	// Corrupted blocks
+	auto sidecar = mapped_string::sidecar_path(file.path);
+	{
+		std::fstream stream(
+			sidecar, std::ios::binary | std::ios::in | std::ios::out
+		);
+		stream.seekp(-1, std::ios::end);
+		stream.put('\x7F');
+	}
+	EXPECT_FALSE(mapped_string(file.path).is_layout_loaded());
+
+	// Truncated header
+	writeFile(sidecar, "ULAYOUT");
+	EXPECT_FALSE(mapped_string(file.path).is_layout_loaded());
+}
+
+TEST(mapped_string, empty_and_missing)
+{
+	temporary_file file;
+	writeFile(file.path, "");
+	{
+		mapped_string string(file.path);
+		ASSERT_TRUE(string);
+		EXPECT_TRUE(string.view().empty());
+		EXPECT_TRUE(string.save_layout());
+	}
+	mapped_string string(file.path);
+	EXPECT_TRUE(string.is_layout_loaded());
+	EXPECT_EQ(string.view().size(), 0);
+
+	EXPECT_FALSE(mapped_string(file.path.string() + ".missing"));
+}
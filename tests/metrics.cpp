@@ -0,0 +1,87 @@
+#include "unicode/metrics.hpp"
+#include "unicode/collator.hpp"
+#include "unicode/string_view.hpp"
+#include "unicode/utf8/normalize.hpp"
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+using namespace unicode;
+using metrics::counter;
+
+TEST(metrics, bucket_of)
+{
+	EXPECT_EQ(metrics::bucket_of(0), 0);
+	EXPECT_EQ(metrics::bucket_of(1), 1);
+	EXPECT_EQ(metrics::bucket_of(2), 2);
+	EXPECT_EQ(metrics::bucket_of(3), 2);
+	EXPECT_EQ(metrics::bucket_of(4), 3);
+	EXPECT_EQ(metrics::bucket_of(SIZE_MAX), metrics::histogram_buckets - 1);
+}
+
+TEST(metrics, disabled)
+{
+	if constexpr (metrics::enabled) { GTEST_SKIP(); }
+
+	string_view view = "Привет, é!";
+	EXPECT_EQ(view.size(), 10);
+	EXPECT_EQ(collator::cached().compare("a", "b"), std::strong_ordering::less);
+
+	auto snapshot = metrics::snapshot();
+	EXPECT_EQ(snapshot[counter::views], 0);
+	EXPECT_EQ(snapshot[counter::comparisons], 0);
+}
+
+TEST(metrics, counters)
+{
+	if constexpr (!metrics::enabled) { GTEST_SKIP(); }
+
+	collator coll("en");
+	metrics::reset();
+
+	// View is built in other thread to check aggregation of finished threads
+	std::thread([]
+	{
+		string_view view = "Привет, é!";
+		EXPECT_EQ(view.size(), 10);
+	}).join();
+	string_view ascii = "Hello";
+	EXPECT_EQ(ascii[1], "e");
+	EXPECT_EQ(ascii.index_of_byte(2), 2);
+
+	EXPECT_EQ(coll.compare("a", "a"), std::strong_ordering::equal);
+	EXPECT_EQ(coll.compare("a", "b"), std::strong_ordering::less);
+	EXPECT_EQ(coll.compare("а", "б"), std::strong_ordering::less);
+	EXPECT_TRUE(utf8::is_nfc("Привет"));
+	EXPECT_FALSE(utf8::is_nfc("é"));
+
+	auto snapshot = metrics::snapshot();
+	EXPECT_EQ(snapshot[counter::views], 2);
+	EXPECT_EQ(
+		snapshot[counter::bytes_segmented], 
+		std::string_view("Привет, é!").size() + 5
+	);
+	// Space before combining mark is passed to ICU too
+	EXPECT_EQ(snapshot[counter::bytes_segmented_by_icu], 4);
+	EXPECT_GE(snapshot[counter::block_lookups], 1);
+	EXPECT_EQ(snapshot[counter::byte_lookups], 1);
+	EXPECT_EQ(snapshot[counter::collators_created], 0);
+	EXPECT_EQ(snapshot[counter::comparisons], 3);
+	EXPECT_EQ(snapshot[counter::comparisons_identical], 1);
+	EXPECT_EQ(
+		snapshot[counter::comparisons_ascii] + 
+			snapshot[counter::comparisons_icu], 
+		2
+	);
+	EXPECT_EQ(snapshot[counter::normalizations_fast], 1);
+	EXPECT_EQ(snapshot[counter::normalizations_icu], 1);
+	EXPECT_GT(snapshot[counter::icu_nanoseconds], 0);
+
+	// Cyrillic text has blocks of 2, 1, 3 and 1 bytes per character
+	EXPECT_EQ(snapshot.blocks_per_layout[metrics::bucket_of(4)], 1);
+	EXPECT_EQ(snapshot.blocks_per_layout[metrics::bucket_of(1)], 1);
+
+	metrics::reset();
+	EXPECT_EQ(metrics::snapshot()[counter::views], 0);
+}
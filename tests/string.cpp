@@ -0,0 +1,113 @@
+#include "unicode/string.hpp"
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace unicode;
+
+/// Check, that string is split into the same characters as fresh view
+static void expect_fresh_layout(const unicode::string &str)
+{
+	unicode::string_view fresh = str.str();
+	ASSERT_EQ(str.size(), fresh.size()) << str.str();
+	EXPECT_EQ(str.view().blocks(), fresh.blocks()) << str.str();
+	for (size_t i = 0; i < fresh.size(); ++i)
+	{
+		EXPECT_EQ(std::string_view(str[i]), std::string_view(fresh[i]));
+	}
+}
+
+TEST(string, modification)
+{
+	unicode::string str = "Hello";
+	EXPECT_EQ(str.size(), 5);
+
+	str.append(", мир");
+	EXPECT_EQ(str.size(), 10);
+	EXPECT_EQ(str.str(), "Hello, мир");
+
+	// Combining mark joins with previous character
+	str.insert(2, "́");
+	EXPECT_EQ(str.size(), 10);
+	EXPECT_EQ(std::string_view(str[1]), "é");
+	expect_fresh_layout(str);
+
+	str += "🇺";
+	str += "🇸";
+	EXPECT_EQ(std::string_view(str.back()), "🇺🇸");
+	expect_fresh_layout(str);
+
+	str.erase(0, 7);
+	EXPECT_EQ(str.str(), "мир🇺🇸");
+	EXPECT_EQ(str.size(), 4);
+
+	str.replace(3, 1, "!");
+	EXPECT_EQ(str.str(), "мир!");
+	expect_fresh_layout(str);
+
+	str.erase(3, 100);
+	EXPECT_EQ(str, unicode::string("мир"));
+
+	str.clear();
+	EXPECT_TRUE(str.empty());
+	EXPECT_EQ(str.size(), 0);
+}
+
+TEST(string, copy_and_move)
+{
+	unicode::string small = "Привет";
+	unicode::string large(std::string(1000, 'a') + "Привет");
+
+	for (auto *str : {&small, &large})
+	{
+		auto copy = *str;
+		EXPECT_EQ(copy.str(), str->str());
+		EXPECT_NE(copy.str().data(), str->str().data());
+		expect_fresh_layout(copy);
+
+		auto data = copy.str().data();
+		auto moved = std::move(copy);
+		expect_fresh_layout(moved);
+		EXPECT_EQ(std::string_view(moved.back()), "т");
+		EXPECT_TRUE(copy.empty());
+		if (str == &large) 
+		{ 
+			// Long strings are moved without reallocation
+			EXPECT_EQ(moved.str().data(), data); 
+		}
+
+		copy = std::move(moved);
+		expect_fresh_layout(copy);
+		moved = copy;
+		expect_fresh_layout(moved);
+	}
+}
+
+TEST(string, random_edits)
+{
+	std::vector<std::string> pieces = {
+		"a", " ", "\n", "\r", "\r\n", "é", "́", "‍", "п", "你", "한", "ᄀ", 
+		"ᅡ", "🇺", "🇸", "👩", "🏽", "क", "्"
+	};
+
+	std::default_random_engine engine{13};
+	std::uniform_int_distribution<size_t> piece(0, pieces.size() - 1);
+	std::uniform_int_distribution<size_t> action(0, 3);
+	unicode::string str;
+	for (size_t i = 0; i < 2000; ++i)
+	{
+		std::uniform_int_distribution<size_t> position(0, str.size());
+		auto index = position(engine);
+		switch (action(engine))
+		{
+		case 0: str.append(pieces[piece(engine)]); break;
+		case 1: str.insert(index, pieces[piece(engine)]); break;
+		case 2: str.erase(index, 2); break;
+		case 3: str.replace(index, 1, pieces[piece(engine)]); break;
+		}
+		expect_fresh_layout(str);
+	}
+}
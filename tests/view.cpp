@@ -1,7 +1,11 @@
 #include "unicode/utf8/compare.hpp"
 #include "unicode/string_view.hpp"
+#include "unicode/utf8/normalize.hpp"
 
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -180,4 +184,556 @@ TEST(string_view, reverse_iteration)
 		EXPECT_EQ(*it, view[index]);
 		--index;
 	}
-}
\ No newline at end of file
+}
+
+TEST(string_view, reverse_iterator_arithmetic)
+{
+	unicode::string_view view = "🇺🇸: Hello, Привет, 你好 e\u0301!";
+	auto size = static_cast<std::ptrdiff_t>(view.size());
+
+	EXPECT_EQ(view.rend() - view.rbegin(), size);
+	EXPECT_TRUE(view.rbegin() < view.rend());
+	EXPECT_EQ(view.rbegin().base(), view.end());
+	EXPECT_EQ(view.rend().base(), view.begin());
+	EXPECT_EQ(view.rbegin() + size, view.rend());
+	EXPECT_EQ(view.rend() - size, view.rbegin());
+	EXPECT_EQ(*(view.rend() - 1), view[0]);
+
+	for (std::ptrdiff_t i = 0; i < size; ++i)
+	{
+		EXPECT_EQ(view.rbegin()[i], view[size - 1 - i]);
+		auto it = view.rend() - (i + 1);
+		EXPECT_EQ(*it, view[i]);
+		EXPECT_EQ(it.base(), view.begin() + (i + 1));
+	}
+
+	auto it = view.rend();
+	for (std::ptrdiff_t i = 0; i < size; ++i) { --it; }
+	EXPECT_EQ(it, view.rbegin());
+
+	unicode::string_view empty;
+	EXPECT_EQ(empty.rbegin(), empty.rend());
+}
+
+TEST(string_view, byte_offsets)
+{
+	std::string str = "🇺🇸: Hello, Привет, 你好 e\u0301!\r\n";
+	for (auto lazy : {false, true})
+	{
+		auto view = lazy ? 
+			unicode::string_view(str, unicode::lazy) : 
+			unicode::string_view(str);
+
+		unicode::string_view expected = str;
+		size_t byte = 0;
+		for (size_t index = 0; index < expected.size(); ++index)
+		{
+			auto character = expected[index];
+			EXPECT_EQ(view.byte_of_index(index), byte);
+			for (size_t i = 0; i < std::string_view(character).size(); ++i)
+			{
+				EXPECT_EQ(view.index_of_byte(byte + i), index) << byte + i;
+			}
+			byte += std::string_view(character).size();
+		}
+		EXPECT_EQ(byte, str.size());
+		EXPECT_EQ(view.index_of_byte(str.size()), view.size());
+		EXPECT_EQ(view.byte_of_index(view.size()), str.size());
+	}
+}
+
+TEST(string_view, iterator_arithmetic)
+{
+	std::string str =
+		"🇺🇸: Hello, world!\n"
+		"🇷🇺: Привет, мир!\n"
+		"🇨🇳: 你好，世界！\n" 
+		"🇯🇵: こんにちは世界！\n" 
+		"🇰🇷: 안녕하세요 세계!\n"
+		"I💜Unicode";
+
+	unicode::string_view view = str;
+
+	auto it = view.end();
+	for (int index = view.size() - 1; index >= 0; --index)
+	{
+		--it;
+		EXPECT_EQ(*it, view[index]);
+	}
+	EXPECT_EQ(it, view.begin());
+
+	for (int step : {1, 2, 3, 5, 7, 13})
+	{
+		auto it = view.begin();
+		for (size_t index = 0; index < view.size(); index += step)
+		{
+			EXPECT_EQ(*it, view[index]);
+			EXPECT_EQ(it[0], view[index]);
+			EXPECT_EQ(it - view.begin(), index);
+			it += step;
+		}
+
+		it = view.end();
+		for (int index = view.size(); index - step >= 0; index -= step)
+		{
+			it -= step;
+			EXPECT_EQ(*it, view[index - step]);
+		}
+	}
+
+	EXPECT_EQ(*(view.begin() + 20), view[20]);
+	EXPECT_EQ(*(view.end() - 1), view.back());
+	EXPECT_EQ(*(view.begin() + 30 - 25), view[5]);
+}
+
+TEST(string_view, lazy)
+{
+	std::string str;
+	for (size_t i = 0; i < 100; ++i)
+	{
+		str += 
+			"🇺🇸: Hello, world!\n"
+			"🇷🇺: Привет, мир!\r\n"
+			"🇨🇳: 你好，世界！\n" 
+			"🇯🇵: こんにちは世界！\n" 
+			"🇰🇷: 안녕하세요 세계!\n"
+			"Café I💜Unicode";
+	}
+	unicode::string_view eager = str;
+
+	{
+		unicode::string_view view(str, unicode::lazy);
+		EXPECT_EQ(view.front(), eager.front());
+		EXPECT_EQ(view[10], eager[10]);
+		EXPECT_FALSE(view.complete());
+		EXPECT_EQ(view, eager);
+		EXPECT_FALSE(view.complete());
+
+		EXPECT_EQ(view.size(), eager.size());
+		EXPECT_TRUE(view.complete());
+		EXPECT_EQ(view.back(), eager.back());
+	}
+
+	{
+		unicode::string_view view(str, unicode::lazy);
+		for (size_t index : {500, 3, 2000, 1999, 7000, 0})
+		{
+			EXPECT_EQ(view[index], eager[index]);
+		}
+	}
+
+	{
+		unicode::string_view view(str, unicode::lazy);
+		auto it = view.begin();
+		for (size_t index = 0; index < eager.size(); ++index, ++it)
+		{
+			ASSERT_EQ(*it, eager[index]) << index;
+		}
+		EXPECT_EQ(it, view.end());
+	}
+
+	{
+		unicode::string_view view(str, unicode::lazy);
+		auto it = view.begin();
+		for (size_t index = 0; index + 37 < eager.size(); index += 37)
+		{
+			ASSERT_EQ(*it, eager[index]) << index;
+			it += 37;
+		}
+	}
+
+	{
+		unicode::string_view view("", unicode::lazy);
+		EXPECT_TRUE(view.complete());
+		EXPECT_TRUE(view.empty());
+		EXPECT_EQ(view.size(), 0);
+	}
+}
+
+TEST(string_view, update)
+{
+	std::string str = "🇺🇸: Hello, world!\n🇷🇺: Привет, мир!";
+	unicode::string_view view = str;
+
+	// e + combining acute joins with previous character
+	str.insert(12, "\u0301");
+	view.update(str, {.offset = 12, .size = 0}, 2);
+	EXPECT_EQ(view, unicode::string_view(str));
+	EXPECT_EQ(view.size(), unicode::string_view(str).size());
+	EXPECT_EQ(view[4], "e\u0301");
+
+	// Replacement of flag
+	str.replace(0, 8, "🇨🇳");
+	view.update(str, {.offset = 0, .size = 8}, 8);
+	EXPECT_EQ(view[0], "🇨🇳");
+	EXPECT_EQ(view.size(), unicode::string_view(str).size());
+
+	// Removal keeps data pointer
+	str.erase(str.size() - 3);
+	view.update({.offset = str.size(), .size = 3}, 0);
+	EXPECT_EQ(view.back(), "и");
+	EXPECT_EQ(view.size(), unicode::string_view(str).size());
+	for (size_t i = 0; i < view.size(); ++i)
+	{
+		EXPECT_EQ(view[i], unicode::string_view(str)[i]);
+	}
+}
+
+TEST(string_view, sampled_update)
+{
+	std::string str;
+	for (size_t i = 0; i < 1000; ++i) { str += i % 2 ? "한" : "a"; }
+	unicode::string_view view = str;
+	ASSERT_EQ(view.blocks().strategy(), layout_strategy::sampled);
+
+	str.replace(1000, 1, "é");
+	view.update(str, {.offset = 1000, .size = 1}, 3);
+	ASSERT_EQ(view.size(), unicode::string_view(str).size());
+	for (size_t i = 0; i < view.size(); ++i)
+	{
+		ASSERT_EQ(view[i], unicode::string_view(str)[i]) << i;
+	}
+}
+
+TEST(string_view, for_each_block)
+{
+	std::string fragmented;
+	for (size_t i = 0; i < 1000; ++i) { fragmented += i % 3 ? "한" : "a"; }
+
+	for (std::string str : {
+		std::string(), 
+		std::string("🇺🇸: Hello, world!\n🇷🇺: Привет, мир!"), 
+		fragmented
+	})
+	{
+		unicode::string_view view = str;
+		std::string joined;
+		std::vector<std::string_view> characters;
+		size_t previous_size = 0;
+		view.for_each_block([&](const character_run &run)
+		{
+			EXPECT_NE(run.character_size, previous_size);
+			previous_size = run.character_size;
+			joined += run.bytes;
+			for (size_t i = 0; i < run.size(); ++i)
+			{
+				characters.push_back(run[i]);
+			}
+		});
+		EXPECT_EQ(joined, str);
+		ASSERT_EQ(characters.size(), view.size());
+		for (size_t i = 0; i < view.size(); ++i)
+		{
+			EXPECT_EQ(characters[i], view[i]);
+		}
+	}
+}
+
+TEST(string_view, visit_blocks)
+{
+	std::string str = "🇺🇸: Hello, world!\n🇷🇺: Привет, мир! 你好 👍🏽";
+	unicode::string_view view = str;
+
+	std::string joined;
+	std::vector<std::string_view> characters;
+	std::vector<size_t> widths;
+	view.visit_blocks([&]<size_t W>(unicode::fixed_width_span<W> span)
+	{
+		if constexpr (W != unicode::dynamic_width)
+		{
+			static_assert(decltype(span)::character_size == W);
+			EXPECT_LE(W, 4u);
+		}
+		else
+		{
+			EXPECT_GT(span.character_size, 4u);
+		}
+		widths.push_back(W);
+		joined += span.bytes;
+		for (size_t i = 0; W != unicode::dynamic_width && i < span.size(); ++i)
+		{
+			EXPECT_EQ(utf8::decode(span[i]).size, W);
+		}
+		for (size_t i = 0; i < span.size(); ++i)
+		{
+			characters.push_back(span[i]);
+		}
+	});
+
+	EXPECT_EQ(joined, str);
+	EXPECT_EQ(
+		widths,
+		(std::vector<size_t>{0, 1, 0, 1, 2, 1, 2, 1, 3, 1, 0})
+	);
+	ASSERT_EQ(characters.size(), view.size());
+	for (size_t i = 0; i < view.size(); ++i)
+	{
+		EXPECT_EQ(characters[i], view[i]);
+	}
+
+	// Clusters of several code points are never of fixed width,
+	// even if they have same size as surrounding characters
+	std::string clusters = "你e\u0301好\r\nи\u0306яab";
+	std::vector<std::pair<size_t, std::string>> spans;
+	unicode::string_view(clusters).visit_blocks(
+		[&]<size_t W>(unicode::fixed_width_span<W> span)
+		{
+			spans.emplace_back(W, span.bytes);
+		}
+	);
+	EXPECT_EQ(spans, (std::vector<std::pair<size_t, std::string>>{
+		{3, "你"}, {0, "e\u0301"}, {3, "好"}, 
+		{0, "\r\n"}, {0, "и\u0306"}, {2, "я"}, {1, "ab"}
+	}));
+}
+
+TEST(string_view, copy_boundaries)
+{
+	std::string str = "🇺🇸: Hello, world!\n🇷🇺: Привет, мир!";
+	unicode::string_view view(str, unicode::lazy);
+
+	std::vector<uint32_t> boundaries(view.size() + 5, 0);
+	EXPECT_EQ(view.copy_boundaries(boundaries), view.size());
+	for (size_t i = 0; i < view.size(); ++i)
+	{
+		EXPECT_EQ(str.data() + boundaries[i], view[i].data());
+	}
+	EXPECT_EQ(boundaries[view.size()], 0u);
+
+	// Part of characters from the middle of string
+	std::vector<uint32_t> part(4);
+	EXPECT_EQ(view.copy_boundaries(part, 20), 4u);
+	EXPECT_TRUE(std::equal(part.begin(), part.end(), boundaries.begin() + 20));
+	EXPECT_EQ(view.copy_boundaries(part, view.size() - 2), 2u);
+	EXPECT_EQ(view.copy_boundaries(part, view.size()), 0u);
+	EXPECT_EQ(view.copy_boundaries({}), 0u);
+}
+
+TEST(string_view, substr)
+{
+	std::string str = "🇺🇸: Hello, world!\n🇷🇺: Привет, мир!";
+	unicode::string_view view = str;
+	for (size_t pos = 0; pos <= view.size(); ++pos)
+	{
+		for (size_t count = 0; pos + count <= view.size() + 1; ++count)
+		{
+			auto slice = view.substr(pos, count);
+			ASSERT_EQ(slice.size(), std::min(count, view.size() - pos));
+			ASSERT_EQ(slice.offset(), pos);
+			for (size_t i = 0; i < slice.size(); ++i)
+			{
+				ASSERT_EQ(slice[i], view[pos + i]);
+			}
+
+			// Bytes of slice are bytes of its characters
+			std::string joined;
+			for (auto c : slice) { joined += c; }
+			ASSERT_EQ(std::string_view(slice), joined);
+		}
+	}
+
+	auto hello = view.substr(3, 5);
+	EXPECT_EQ(hello, hello.substr(0));
+	EXPECT_LT(hello, view.substr(10, 5));
+	EXPECT_EQ(std::string_view(hello), "Hello");
+	EXPECT_EQ(hello.front(), "H");
+	EXPECT_EQ(hello.back(), "o");
+	EXPECT_EQ(view.substr(4), view.substr(4, view.npos));
+	EXPECT_EQ(view.substr(view.size()).size(), 0u);
+	EXPECT_TRUE(view.substr(view.size()).empty());
+	EXPECT_EQ(std::string_view(view.substr(0, 1)), "🇺🇸");
+
+	// Slices of slices and slices by iterators
+	EXPECT_EQ(std::string_view(hello.substr(1, 3)), "ell");
+	EXPECT_EQ(std::string_view(hello.substr(3)), "lo");
+	auto russian = view.slice(view.end() - 12, view.end());
+	EXPECT_EQ(std::string_view(russian), "Привет, мир!");
+	EXPECT_EQ(russian.size(), 12u);
+	EXPECT_EQ(std::string_view(*russian.rbegin()), "!");
+	EXPECT_EQ(std::string_view(russian.substr(8, 3)), "мир");
+
+	unicode::string_view empty;
+	EXPECT_TRUE(empty.substr().empty());
+	EXPECT_EQ(std::string_view(empty.substr()), "");
+}
+
+TEST(string_view, lazy_substr)
+{
+	std::string str;
+	for (size_t i = 0; i < 1000; ++i) { str += "Привет, мир! "; }
+	unicode::string_view view(str, unicode::lazy);
+
+	auto greeting = view.substr(13, 6);
+	EXPECT_FALSE(view.complete());
+	EXPECT_EQ(std::string_view(greeting), "Привет");
+
+	EXPECT_EQ(view.substr(view.size() - 5).size(), 5u);
+	EXPECT_EQ(std::string_view(view.substr(view.size() - 5, 4)), "мир!");
+}
+
+TEST(string_view, from_checked)
+{
+	for (std::string_view text : {
+		"", "Hello", "Привет, мир! 👍🏽 🇺🇸", "e\u0301\r\n中文"
+	})
+	{
+		auto checked = string_view::from_checked(text);
+		ASSERT_TRUE(checked) << text;
+		EXPECT_EQ(checked.error_offset, string_view::npos);
+
+		string_view expected = text;
+		EXPECT_EQ(checked->size(), expected.size());
+		EXPECT_TRUE(std::equal(
+			checked->begin(), checked->end(), 
+			expected.begin(), expected.end(),
+			[](auto lhs, auto rhs) 
+			{ 
+				return std::string_view(lhs) == std::string_view(rhs); 
+			}
+		));
+	}
+
+	std::pair<std::string_view, size_t> ill_formed[] = {
+		{"abc\xFF", 3},
+		{"\x80", 0},
+		{"Привет\xD0", 12},
+		{"a\xE0\x80\x80", 1}, // Overlong encoding
+		{"ab\xED\xA0\x80", 2}, // Surrogate
+		{"x\xF4\x90\x80\x80", 1}, // Above U+10FFFF
+		{"é\xC0\xAF", 2},
+		{"👍🏽\xF0\x9F", 8},
+		{"\r\n\xC3", 2},
+	};
+	for (auto [text, offset] : ill_formed)
+	{
+		auto checked = string_view::from_checked(text);
+		EXPECT_FALSE(checked);
+		EXPECT_EQ(checked.error_offset, offset);
+		EXPECT_TRUE(checked.view.empty());
+	}
+}
+
+TEST(string_view, find)
+{
+	std::string str = "🇺🇸: Hello, world!\né é e 🇺🇸🇷🇺 Привет, мир!";
+	unicode::string_view view = str;
+
+	EXPECT_EQ(view.find("Hello"), 3u);
+	EXPECT_EQ(view.find("o"), 7u);
+	EXPECT_EQ(view.find("o", 8), 11u);
+	EXPECT_EQ(view.find("missing"), view.npos);
+	EXPECT_EQ(view.find(""), 0u);
+	EXPECT_EQ(view.find("", view.size()), view.size());
+	EXPECT_EQ(view.find("", view.size() + 1), view.npos);
+	EXPECT_EQ(view.find("!", view.size()), view.npos);
+
+	// Matches, that split characters, are skipped
+	EXPECT_EQ(view[17], "é");
+	EXPECT_EQ(view.find("e", 5), 21u);
+	EXPECT_EQ(view.rfind("e"), 21u);
+	EXPECT_EQ(view.find("é"), 17u);
+	EXPECT_EQ(view.find("́"), view.npos);
+	EXPECT_EQ(view.find("🇸🇷"), view.npos);
+	EXPECT_EQ(view.find("🇺🇸"), 0u);
+	EXPECT_EQ(view.find("🇺🇸", 1), 23u);
+	EXPECT_EQ(view.rfind("🇺🇸"), 23u);
+	EXPECT_EQ(view.rfind("🇺🇸", 22), 0u);
+	EXPECT_EQ(view.find("🇷🇺"), 24u);
+
+	EXPECT_EQ(view.rfind("o"), 11u);
+	EXPECT_EQ(view.rfind("o", 10), 7u);
+	EXPECT_EQ(view.rfind("мир"), view.size() - 4);
+	EXPECT_EQ(view.rfind(""), view.size());
+	EXPECT_EQ(view.rfind("🇺🇸:", 0), 0u);
+
+	EXPECT_TRUE(view.contains("world"));
+	EXPECT_TRUE(view.contains("é"));
+	EXPECT_FALSE(view.contains("́"));
+
+	EXPECT_TRUE(view.starts_with("🇺🇸"));
+	EXPECT_TRUE(view.starts_with(""));
+	EXPECT_FALSE(view.starts_with("🇺"));
+	EXPECT_TRUE(view.ends_with("мир!"));
+	EXPECT_TRUE(view.ends_with(""));
+	EXPECT_FALSE(view.ends_with("world"));
+	EXPECT_FALSE(unicode::string_view("é").starts_with("e"));
+	EXPECT_FALSE(unicode::string_view("🇺🇸").ends_with("🇸"));
+
+	unicode::string_view lazy(str, unicode::lazy);
+	EXPECT_EQ(lazy.find("мир"), view.find("мир"));
+
+	// Lazy view is split only around the checked boundary
+	std::string text = "e\u0301🇺🇸";
+	for (size_t i = 0; i < 1000; ++i) { text += "Привет, мир! "; }
+	text += "e\u0301";
+	unicode::string_view prefixed(text, unicode::lazy);
+	EXPECT_FALSE(prefixed.starts_with("e"));
+	EXPECT_FALSE(prefixed.starts_with("e\u0301🇺"));
+	EXPECT_TRUE(prefixed.starts_with("e\u0301🇺🇸"));
+	EXPECT_FALSE(prefixed.complete());
+	EXPECT_FALSE(prefixed.ends_with("\u0301"));
+	EXPECT_TRUE(prefixed.ends_with("e\u0301"));
+	EXPECT_TRUE(prefixed.ends_with("мир! e\u0301"));
+	EXPECT_EQ(prefixed.size(), unicode::string_view(text).size());
+}
+
+TEST(UTF8, normalization)
+{
+	EXPECT_TRUE(utf8::is_nfc("Hello, world!"));
+	EXPECT_TRUE(utf8::is_nfc("é"));
+	EXPECT_TRUE(utf8::is_nfc("Привет, 你好"));
+	EXPECT_FALSE(utf8::is_nfc("e\u0301"));
+	EXPECT_EQ(utf8::to_nfc("e\u0301"), "é");
+	EXPECT_EQ(utf8::to_nfc("Ω"), "Ω");
+
+	EXPECT_TRUE(utf8::canonically_equal("é", "e\u0301"));
+	EXPECT_TRUE(utf8::canonically_equal("a\u0323\u0302", "a\u0302\u0323"));
+	EXPECT_FALSE(utf8::canonically_equal("e", "e\u0301"));
+	EXPECT_FALSE(utf8::canonically_equal("a", "A"));
+	EXPECT_EQ(utf8::canonical_hash("é"), utf8::canonical_hash("e\u0301"));
+
+	// Canonically equivalent strings, that are in FCD form, 
+	// are also equal for collator
+	for (auto [lhs, rhs] : {
+		std::pair{"é", "e\u0301"}, 
+		std::pair{"ệ", "e\u0323\u0302"},
+		std::pair{"Ω", "Ω"}
+	})
+	{
+		EXPECT_TRUE(utf8::canonically_equal(lhs, rhs));
+		EXPECT_TRUE(utf8::equal(lhs, rhs)) << lhs;
+	}
+
+	// Collator doesn't normalize, so it may tell apart canonically 
+	// equivalent strings, that aren't in FCD form
+	EXPECT_TRUE(utf8::canonically_equal("\u1E9B\u0323", "\u017F\u0323\u0307"));
+	EXPECT_FALSE(utf8::equal("\u1E9B\u0323", "\u017F\u0323\u0307"));
+
+	// Collator ignores ZWJ, while canonical equivalence doesn't
+	character_view joined("a\u200D"), single("a");
+	EXPECT_EQ(joined, single);
+	EXPECT_FALSE(character_equal{}(joined, single));
+}
+
+TEST(character_view, hash)
+{
+	std::string str = "café cafe\u0301 🇺🇸 Ω Ω";
+	unicode::string_view view = str;
+
+	std::unordered_map<
+		character_view, size_t, character_hash, character_equal
+	> histogram;
+	for (auto c : view) { ++histogram[c]; }
+	EXPECT_EQ(histogram[character_view("é")], 2u);
+	EXPECT_EQ(histogram[character_view("e\u0301")], 2u);
+	EXPECT_EQ(histogram[character_view("Ω")], 2u);
+	EXPECT_EQ(histogram[character_view("🇺🇸")], 1u);
+	EXPECT_EQ(histogram[character_view(" ")], 4u);
+
+	std::unordered_set<
+		character_view, character_hash, character_equal
+	> set(view.begin(), view.end());
+	EXPECT_EQ(set.size(), 7u);
+	EXPECT_TRUE(set.contains(character_view("e\u0301")));
+	EXPECT_FALSE(set.contains(character_view("e")));
+}
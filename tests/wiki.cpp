@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <thread>
+#include <vector>
 
 #include <gtest/gtest.h>
 
@@ -40,10 +42,37 @@ static std::string readFile(const std::string &path)
 		} \
 	}
 
+#define TEST_PARALLEL_LAYOUT(language) \
+	TEST(wiki_parallel, language) \
+	{ \
+		auto content = readFile("../../data/" #language "/wiki.txt"); \
+		auto expected = layout::of(content); \
+		for (size_t chunk_size : {1, 16, 100, 1000}) \
+		{ \
+			std::vector<std::jthread> threads; \
+			auto layout = layout::of( \
+				content, \
+				[&](auto task) { threads.emplace_back(std::move(task)); }, \
+				chunk_size \
+			); \
+			EXPECT_EQ(layout, expected) << chunk_size; \
+			EXPECT_EQ(layout.integer_width(), expected.integer_width()); \
+			EXPECT_EQ(layout.allocated_bytes(), expected.allocated_bytes()); \
+		} \
+	}
+
 TEST_LANGUAGE(english);
 TEST_LANGUAGE(russian);
 TEST_LANGUAGE(chinese);
 TEST_LANGUAGE(french);
 TEST_LANGUAGE(german);
 TEST_LANGUAGE(japanese);
-TEST_LANGUAGE(korean);
\ No newline at end of file
+TEST_LANGUAGE(korean);
+
+TEST_PARALLEL_LAYOUT(english);
+TEST_PARALLEL_LAYOUT(russian);
+TEST_PARALLEL_LAYOUT(chinese);
+TEST_PARALLEL_LAYOUT(french);
+TEST_PARALLEL_LAYOUT(german);
+TEST_PARALLEL_LAYOUT(japanese);
+TEST_PARALLEL_LAYOUT(korean);